@@ -0,0 +1,459 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#include "istok/ecs.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace Istok::ECS;
+
+namespace {
+
+constexpr std::string_view kUsage =
+R"(Usage: ecs_benchmark [options]
+  --entities=N,...       entity counts (default 1000,10000,100000,1000000)
+  --components=N,...     components per entity, 1 to 4 (default 1,2,4)
+  --fragmentation=P,...  percent of entities recreated in random order
+                         before measuring (default 0,50)
+  --repeat=N             runs per case, the fastest one is kept (default 3)
+  --format=F             table, csv or json (default table)
+  --output=FILE          write results to FILE instead of stdout
+  --baseline=FILE        compare with a csv written by an earlier run
+  --threshold=P          slowdown in percent reported as a regression,
+                         fractional values like 2.5 allowed (default 10)
+The exit code is 1 if the baseline comparison finds a regression.
+)";
+
+struct Position {
+    float x;
+    float y;
+};
+
+struct Velocity {
+    float dx;
+    float dy;
+};
+
+struct Health {
+    int value;
+};
+
+struct Mass {
+    float value;
+};
+
+constexpr size_t kMaxComponents = 4;
+
+volatile float sink;
+
+struct Config {
+    std::vector<size_t> entities{1'000, 10'000, 100'000, 1'000'000};
+    std::vector<size_t> components{1, 2, 4};
+    std::vector<size_t> fragmentation{0, 50};
+    size_t repeat = 3;
+    std::string format = "table";
+    std::string output;
+    std::string baseline;
+    double threshold = 10;
+};
+
+struct Case {
+    std::string_view backend;
+    size_t entities;
+    size_t components;
+    size_t fragmentation;
+};
+
+struct Result {
+    Case params;
+    std::string_view benchmark;
+    double ms;
+
+    double nsPerEntity() const noexcept {
+        return ms * 1e6 / double(params.entities);
+    }
+
+    // Identifies the same measurement across runs.
+    std::string key() const {
+        std::ostringstream out;
+        out << params.backend << ',' << benchmark << ','
+            << params.entities << ',' << params.components << ','
+            << params.fragmentation;
+        return out.str();
+    }
+};
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+double measure(F&& func) {
+    auto start = Clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(
+        Clock::now() - start).count();
+}
+
+template <typename Manager>
+void insertComponents(
+    Manager& ecs, Entity entity, size_t components, size_t i
+) {
+    ecs.insert(entity, Position{float(i), 0});
+    if (components > 1) {
+        ecs.insert(entity, Velocity{1, 1});
+    }
+    if (components > 2) {
+        ecs.insert(entity, Health{100});
+    }
+    if (components > 3) {
+        ecs.insert(entity, Mass{1});
+    }
+}
+
+// Read-only each() over the components, summing the positions.
+template <typename Manager, typename... Components>
+double viewOf(Manager& ecs) {
+    float sum = 0;
+    double ms = measure([&] {
+        ecs.template each<const Components...>(
+            [&sum](Entity, const Components&... components) {
+                sum += std::get<const Position&>(
+                    std::tie(components...)).x;
+            });
+    });
+    sink = sum;
+    return ms;
+}
+
+// View over all the components an entity has.
+template <typename Manager>
+double viewAll(Manager& ecs, size_t components) {
+    switch (components) {
+    case 1:
+        return viewOf<Manager, Position>(ecs);
+    case 2:
+        return viewOf<Manager, Position, Velocity>(ecs);
+    case 3:
+        return viewOf<Manager, Position, Velocity, Health>(ecs);
+    default:
+        return viewOf<Manager, Position, Velocity, Health, Mass>(ecs);
+    }
+}
+
+// One run of every benchmark on a fresh world. Fragmentation destroys
+// a random part of the entities and creates them again, so that entity
+// indices, storage order and recycled generations no longer line up.
+template <typename Manager>
+std::vector<std::pair<std::string_view, double>> runOnce(const Case& params) {
+    std::vector<std::pair<std::string_view, double>> times;
+    std::mt19937 random(42);
+    Manager ecs;
+    std::vector<Entity> entities;
+    entities.reserve(params.entities);
+
+    times.emplace_back("create", measure([&] {
+        for (size_t i = 0; i < params.entities; ++i) {
+            Entity entity = ecs.createEntity();
+            entities.push_back(entity);
+            insertComponents(ecs, entity, params.components, i);
+        }
+    }));
+
+    std::shuffle(entities.begin(), entities.end(), random);
+    size_t recreated = params.entities * params.fragmentation / 100;
+    for (size_t i = 0; i < recreated; ++i) {
+        ecs.removeEntity(entities[i]);
+    }
+    for (size_t i = 0; i < recreated; ++i) {
+        entities[i] = ecs.createEntity();
+        insertComponents(ecs, entities[i], params.components, i);
+    }
+    std::shuffle(entities.begin(), entities.end(), random);
+
+    float sum = 0;
+    times.emplace_back("get", measure([&] {
+        for (Entity entity : entities) {
+            sum += ecs.template get<Position>(entity).x;
+        }
+    }));
+    sink = sum;
+
+    times.emplace_back("view1", viewOf<Manager, Position>(ecs));
+    times.emplace_back("view_all", viewAll(ecs, params.components));
+
+    times.emplace_back("remove", measure([&] {
+        for (Entity entity : entities) {
+            ecs.template remove<Position>(entity);
+        }
+    }));
+    times.emplace_back("insert", measure([&] {
+        for (Entity entity : entities) {
+            ecs.insert(entity, Position{1, 0});
+        }
+    }));
+
+    times.emplace_back("destroy", measure([&] {
+        for (Entity entity : entities) {
+            ecs.removeEntity(entity);
+        }
+    }));
+    return times;
+}
+
+template <typename Manager>
+void run(const Case& params, size_t repeat, std::vector<Result>& results) {
+    size_t first = results.size();
+    for (size_t i = 0; i < repeat; ++i) {
+        auto times = runOnce<Manager>(params);
+        for (size_t j = 0; j < times.size(); ++j) {
+            if (i == 0) {
+                results.push_back({params, times[j].first, times[j].second});
+            } else {
+                double& ms = results[first + j].ms;
+                ms = std::min(ms, times[j].second);
+            }
+        }
+    }
+}
+
+void writeTable(std::ostream& out, const std::vector<Result>& results) {
+    out << std::left << std::setw(12) << "backend"
+        << std::setw(10) << "benchmark"
+        << std::right << std::setw(10) << "entities"
+        << std::setw(12) << "components"
+        << std::setw(15) << "fragmentation"
+        << std::setw(12) << "ms"
+        << std::setw(14) << "ns/entity" << '\n';
+    for (const Result& result : results) {
+        out << std::left << std::setw(12) << result.params.backend
+            << std::setw(10) << result.benchmark
+            << std::right << std::setw(10) << result.params.entities
+            << std::setw(12) << result.params.components
+            << std::setw(14) << result.params.fragmentation << '%'
+            << std::fixed << std::setprecision(3)
+            << std::setw(12) << result.ms
+            << std::setw(14) << result.nsPerEntity() << '\n';
+    }
+}
+
+void writeCsv(std::ostream& out, const std::vector<Result>& results) {
+    out << "backend,benchmark,entities,components,fragmentation,"
+        "ms,ns_per_entity\n";
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (const Result& result : results) {
+        out << result.key() << ',' << result.ms << ','
+            << result.nsPerEntity() << '\n';
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results) {
+    out << "[\n";
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        out << "  {\"backend\": \"" << result.params.backend
+            << "\", \"benchmark\": \"" << result.benchmark
+            << "\", \"entities\": " << result.params.entities
+            << ", \"components\": " << result.params.components
+            << ", \"fragmentation\": " << result.params.fragmentation
+            << ", \"ms\": " << result.ms
+            << ", \"ns_per_entity\": " << result.nsPerEntity()
+            << (i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    out << "]\n";
+}
+
+// Reads ns_per_entity by key from a csv written by writeCsv().
+// Reports the first malformed line and returns nothing.
+std::optional<std::map<std::string, double>> readBaseline(
+    const std::string& path
+) {
+    std::ifstream in(path);
+    if (!in) {
+        return std::nullopt;
+    }
+    std::map<std::string, double> baseline;
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        size_t nsSeparator = line.rfind(',');
+        size_t msSeparator = nsSeparator == std::string::npos
+            || nsSeparator == 0
+            ? std::string::npos
+            : line.rfind(',', nsSeparator - 1);
+        double value = 0;
+        const char* end = line.data() + line.size();
+        auto [parsed, error] = msSeparator == std::string::npos
+            ? std::from_chars_result{end, std::errc::invalid_argument}
+            : std::from_chars(line.data() + nsSeparator + 1, end, value);
+        if (error != std::errc() || parsed != end) {
+            std::cerr << "malformed baseline line: " << line << '\n';
+            return std::nullopt;
+        }
+        baseline[line.substr(0, msSeparator)] = value;
+    }
+    return baseline;
+}
+
+// Prints the results slower than the baseline by more than
+// the threshold percentage, returns their number.
+size_t compare(
+    const std::vector<Result>& results,
+    const std::map<std::string, double>& baseline,
+    double threshold
+) {
+    size_t regressions = 0;
+    for (const Result& result : results) {
+        auto it = baseline.find(result.key());
+        if (it == baseline.end() || it->second <= 0) {
+            continue;
+        }
+        double change = (result.nsPerEntity() / it->second - 1) * 100;
+        if (change > threshold) {
+            ++regressions;
+            std::cerr << "regression: " << result.key()
+                << std::fixed << std::setprecision(3)
+                << " " << it->second << " -> " << result.nsPerEntity()
+                << " ns/entity (+" << std::setprecision(1) << change
+                << "%)\n";
+        }
+    }
+    return regressions;
+}
+
+template <typename T>
+bool parseNumber(std::string_view text, T& value) {
+    auto [end, error] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+bool parseList(std::string_view text, std::vector<size_t>& values) {
+    values.clear();
+    while (true) {
+        size_t separator = text.find(',');
+        size_t value;
+        if (!parseNumber(text.substr(0, separator), value)) {
+            return false;
+        }
+        values.push_back(value);
+        if (separator == std::string_view::npos) {
+            return true;
+        }
+        text.remove_prefix(separator + 1);
+    }
+}
+
+bool parseArgs(int argc, char* argv[], Config& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        size_t separator = arg.find('=');
+        if (separator == std::string_view::npos) {
+            return false;
+        }
+        std::string_view name = arg.substr(0, separator);
+        std::string_view value = arg.substr(separator + 1);
+        bool valid = true;
+        if (name == "--entities") {
+            valid = parseList(value, config.entities)
+                && !std::ranges::count(config.entities, 0);
+        } else if (name == "--components") {
+            valid = parseList(value, config.components)
+                && std::ranges::all_of(config.components, [](size_t n) {
+                    return n >= 1 && n <= kMaxComponents;
+                });
+        } else if (name == "--fragmentation") {
+            valid = parseList(value, config.fragmentation)
+                && std::ranges::all_of(config.fragmentation, [](size_t p) {
+                    return p <= 100;
+                });
+        } else if (name == "--repeat") {
+            valid = parseNumber(value, config.repeat) && config.repeat > 0;
+        } else if (name == "--format") {
+            config.format = value;
+            valid = value == "table" || value == "csv" || value == "json";
+        } else if (name == "--output") {
+            config.output = value;
+        } else if (name == "--baseline") {
+            config.baseline = value;
+        } else if (name == "--threshold") {
+            valid = parseNumber(value, config.threshold)
+                && config.threshold >= 0;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    if (!parseArgs(argc, argv, config)) {
+        std::cerr << kUsage;
+        return 2;
+    }
+    std::optional<std::map<std::string, double>> baseline;
+    if (!config.baseline.empty()) {
+        baseline = readBaseline(config.baseline);
+        if (!baseline) {
+            std::cerr << "cannot read " << config.baseline << '\n';
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    for (size_t entities : config.entities) {
+        for (size_t components : config.components) {
+            for (size_t fragmentation : config.fragmentation) {
+                run<ECSManager>(
+                    {"sparse-set", entities, components, fragmentation},
+                    config.repeat, results);
+                run<ArchetypeECSManager>(
+                    {"archetype", entities, components, fragmentation},
+                    config.repeat, results);
+            }
+        }
+    }
+
+    std::ofstream file;
+    if (!config.output.empty()) {
+        file.open(config.output);
+        if (!file) {
+            std::cerr << "cannot write " << config.output << '\n';
+            return 2;
+        }
+    }
+    std::ostream& out = config.output.empty() ? std::cout : file;
+    if (config.format == "csv") {
+        writeCsv(out, results);
+    } else if (config.format == "json") {
+        writeJson(out, results);
+    } else {
+        writeTable(out, results);
+    }
+
+    if (baseline && compare(results, *baseline, config.threshold)) {
+        return 1;
+    }
+    return 0;
+}
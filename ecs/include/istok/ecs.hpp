@@ -1,91 +1,573 @@
 // Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <concepts>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 #include <ranges>
+#include <type_traits>
+#include <vector>
 
+#include "ecs/archetype.hpp"
+#include "ecs/command_buffer.hpp"
 #include "ecs/component.hpp"
 #include "ecs/entity.hpp"
+#include "ecs/hierarchy.hpp"
+#include "ecs/resource.hpp"
+#include "ecs/snapshot.hpp"
 #include "ecs/system.hpp"
+#include "ecs/term.hpp"
+#include "ecs/thread_pool.hpp"
 
 namespace Istok::ECS {
 
-class ECSManager {
+namespace Internal {
+
+// Backend of the BasicECSManager methods constrained by it,
+// they rely on the sparse-set storages and are absent from
+// ArchetypeECSManager.
+template <typename Backend>
+concept SparseSetBackend = std::same_as<Backend, ComponentManager>;
+
+// Whether the term hands out a mutable HierarchyNode. Optional passes
+// a pointer to its component, Added and Changed a const reference.
+template <typename Term>
+struct WritesNode
+: std::is_same<std::remove_reference_t<Term>, HierarchyNode> {};
+
+template <typename Component>
+struct WritesNode<Optional<Component>> : WritesNode<Component> {};
+
+template <typename Component>
+struct WritesNode<Added<Component>> : std::false_type {};
+
+template <typename Component>
+struct WritesNode<Changed<Component>> : std::false_type {};
+
+}  // namespace Internal
+
+
+template <typename ComponentBackend>
+class BasicECSManager {
 public:
-    ECSManager() = default;
+    BasicECSManager() = default;
+
+    // Entity and component containers are allocated from the resource,
+    // e.g. an arena released at once with a short-lived world.
+    // The resource must outlive the manager. The global heap still holds
+    // the per-type objects: storage, group and query headers, signature
+    // masks, listeners, the archetype signature map and the resources
+    // set by setResource(). So do the thread pool, the systems and the
+    // scratch buffers of snapshots, deltas and hierarchy passes.
+    explicit BasicECSManager(std::pmr::memory_resource* resource)
+    : entityManager_(std::make_unique<Internal::EntityManager>(resource)),
+        componentManager_(resource),
+        resourceManager_(resource) {}
 
-    ~ECSManager() {
+    ~BasicECSManager() {
         systemManager_.clear();
         componentManager_.clear();
+        resourceManager_.clear();
     }
 
-    ECSManager(const ECSManager&) = delete;
-    ECSManager& operator=(const ECSManager&) = delete;
-    ECSManager(ECSManager&&) = default;
-    ECSManager& operator=(ECSManager&&) = default;
+    BasicECSManager(const BasicECSManager&) = delete;
+    BasicECSManager& operator=(const BasicECSManager&) = delete;
+    BasicECSManager(BasicECSManager&&) = default;
+    BasicECSManager& operator=(BasicECSManager&&) = default;
 
     bool isValidEntity(Entity entity) const noexcept {
-        return entityManager_.isValid(entity);
+        return entityManager_->isValid(entity);
     }
 
     Entity createEntity() noexcept {
-        return entityManager_.create();
+        assertSerial();
+        return entityManager_->create();
+    }
+
+    std::vector<Entity> createEntities(size_t count) {
+        assertSerial();
+        std::vector<Entity> result;
+        result.reserve(count);
+        entityManager_->reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            result.push_back(entityManager_->create());
+        }
+        return result;
     }
 
+    // Children of the entity in the hierarchy become roots.
     void removeEntity(Entity entity) noexcept {
+        assertSerial();
         assert(isValidEntity(entity));
+        hierarchy_.remove(componentManager_, entity.index());
         componentManager_.clearIndex(entity.index());
-        entityManager_.remove(entity);
+        entityManager_->remove(entity);
+    }
+
+    // Convenience wrapper calling removeEntity() for every entity,
+    // there is no batched removal path.
+    template <std::ranges::input_range Entities>
+    void removeEntities(Entities&& entities) noexcept {
+        for (Entity entity : entities) {
+            removeEntity(entity);
+        }
     }
 
     template <typename Component>
     bool has(Entity entity) const noexcept {
         assert(isValidEntity(entity));
-        return componentManager_.has<Component>(entity.index());
+        return componentManager_.template has<Component>(entity.index());
     }
 
     template <typename Component>
     size_t count() const noexcept {
-        return componentManager_.count<Component>();
+        return componentManager_.template count<Component>();
     }
 
     template <typename Component>
     void insert(Entity entity, Component&& component) noexcept {
+        rejectNodeWrites<std::remove_cvref_t<Component>>();
+        assertSerial();
         assert(isValidEntity(entity));
         componentManager_.insert(
             entity.index(), std::forward<Component>(component));
     }
 
+    // Inserts components[i] into entities[i] as one batch: the
+    // sparse-set storage appends the new components as a block,
+    // the archetype backend reserves every target archetype once.
+    // The components are moved if the range is passed as an rvalue.
+    // Returns false and inserts nothing if the lengths differ.
+    template <
+        std::ranges::input_range Entities,
+        std::ranges::input_range Components>
+        requires std::ranges::sized_range<Components>
+    bool insert(Entities&& entities, Components&& components) {
+        using Component = std::ranges::range_value_t<Components>;
+        rejectNodeWrites<Component>();
+        assertSerial();
+        std::vector<size_t> indices;
+        if constexpr (std::ranges::sized_range<Entities>) {
+            indices.reserve(std::ranges::size(entities));
+        }
+        for (Entity entity : entities) {
+            assert(isValidEntity(entity));
+            indices.push_back(entity.index());
+        }
+        if (indices.size() != std::ranges::size(components)) {
+            return false;
+        }
+        componentManager_.template insertRange<Component>(
+            indices, std::forward<Components>(components));
+        return true;
+    }
+
+    // Applies func to the component and signals the update.
+    template <typename Component, typename Func>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void patch(Entity entity, Func&& func) noexcept {
+        rejectNodeWrites<Component>();
+        assert(isValidEntity(entity));
+        assert(has<Component>(entity));
+        func(componentManager_.template get<Component>(entity.index()));
+        Internal::StorageSignals::emit(
+            componentManager_.template signals<Component>().update,
+            entity.index());
+    }
+
+    // Lifecycle listeners called with the entity: construction after
+    // insertion, update after replacement or patch() and destruction
+    // before removal. Without listeners every event costs a single
+    // branch. Listeners must not change the entity structure.
+    template <typename Component, typename Func>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void onConstruct(Func&& func) {
+        componentManager_.template signals<Component>().construct
+            .push_back(makeListener(std::forward<Func>(func)));
+    }
+
+    template <typename Component, typename Func>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void onUpdate(Func&& func) {
+        componentManager_.template signals<Component>().update
+            .push_back(makeListener(std::forward<Func>(func)));
+    }
+
+    template <typename Component, typename Func>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void onDestroy(Func&& func) {
+        componentManager_.template signals<Component>().destroy
+            .push_back(makeListener(std::forward<Func>(func)));
+    }
+
+    // Reserves room for count more components of the type.
+    template <typename Component>
+    void reserve(size_t count) noexcept {
+        componentManager_.template reserve<Component>(count);
+    }
+
     template <typename Component>
     Component& get(Entity entity) noexcept {
+        rejectNodeWrites<Component>();
         assert(isValidEntity(entity));
         assert(has<Component>(entity));
-        return componentManager_.get<Component>(entity.index());
+        return componentManager_.template get<Component>(entity.index());
     }
 
     template <typename Component>
     void remove(Entity entity) noexcept {
+        rejectNodeWrites<std::remove_cvref_t<Component>>();
+        assertSerial();
         assert(isValidEntity(entity));
         assert(has<Component>(entity));
-        componentManager_.remove<Component>(entity.index());
+        componentManager_.template remove<Component>(entity.index());
     }
 
     template <typename Component>
     void removeAll() noexcept {
-        componentManager_.removeAll<Component>();
+        rejectNodeWrites<std::remove_cvref_t<Component>>();
+        assertSerial();
+        componentManager_.template removeAll<Component>();
+    }
+
+    // Makes the child the first child of the parent in O(1), moving it
+    // from its previous parent. Both get a HierarchyNode component.
+    // The parent must not be a descendant of the child.
+    void setParent(Entity child, Entity parent) 
+        requires Internal::SparseSetBackend<ComponentBackend>
+    {
+        assertSerial();
+        assert(isValidEntity(child));
+        assert(isValidEntity(parent));
+        hierarchy_.setParent(componentManager_, child.index(), parent);
+    }
+
+    // Makes the child a root.
+    void removeParent(Entity child) 
+        requires Internal::SparseSetBackend<ComponentBackend>
+    {
+        assertSerial();
+        assert(isValidEntity(child));
+        hierarchy_.removeParent(componentManager_, child.index());
+    }
+
+    std::optional<Entity> parent(Entity child) const noexcept
+        requires Internal::SparseSetBackend<ComponentBackend>
+    {
+        assert(isValidEntity(child));
+        return hierarchy_.parent(componentManager_, child.index());
+    }
+
+    // Calls func(child) for every child, the most recently added first.
+    template <typename Func>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void eachChild(Entity parent, Func&& func) {
+        assert(isValidEntity(parent));
+        hierarchy_.eachChild(
+            componentManager_, parent.index(),
+            [this, &func](size_t index) { func(entityManager_->get(index)); });
+    }
+
+    // Calls func(entity, parent) for every entity in the hierarchy with
+    // parents before their descendants, parent is empty for roots.
+    // The HierarchyNode storage is reordered depth-first after structural
+    // changes, so the pass is linear, and components aligned with it by
+    // sortAs<Component, HierarchyNode>() are visited sequentially too.
+    // A grouped node storage keeps its order and is visited by links.
+    // sort(), sortAs() and group() of the nodes make the next pass
+    // rebuild the order.
+    template <typename Func>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void eachDepthFirst(Func&& func) {
+        assertSerial();
+        hierarchy_.each(
+            componentManager_,
+            [this, &func](size_t index, std::optional<Entity> parent) {
+                func(entityManager_->get(index), parent);
+            });
+    }
+
+    // Single instance of T constructed from args, replacing the previous
+    // one. Lookups load it by the type id, the reference stays valid
+    // until the resource is replaced or removed, so systems may keep it.
+    template <typename T, typename... Args>
+    T& setResource(Args&&... args) {
+        assertSerial();
+        return resourceManager_.template set<T>(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    T& resource() noexcept {
+        assert(tryResource<T>());
+        return *resourceManager_.template find<T>();
+    }
+
+    template <typename T>
+    const T& resource() const noexcept {
+        assert(tryResource<T>());
+        return *resourceManager_.template find<T>();
+    }
+
+    template <typename T>
+    T* tryResource() noexcept {
+        return resourceManager_.template find<T>();
+    }
+
+    template <typename T>
+    const T* tryResource() const noexcept {
+        return resourceManager_.template find<T>();
+    }
+
+    template <typename T>
+    void removeResource() noexcept {
+        assertSerial();
+        resourceManager_.template remove<T>();
     }
 
-    template<typename... Components>
+    template<typename... Terms>
     auto view() noexcept {
-        return componentManager_.view<Components...>()
+        return componentManager_.template view<Terms...>()
+            | std::ranges::views::transform(
+                [em=entityManager_.get()](size_t index) {
+                    return em->get(index); });
+    }
+
+    // Added and Changed terms match ticks after since.
+    template<typename... Terms>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    auto view(Tick since) noexcept {
+        return componentManager_.template view<Terms...>(since)
+            | std::ranges::views::transform(
+                [em=entityManager_.get()](size_t index) {
+                    return em->get(index); });
+    }
+
+    // Entities matching the terms, kept by a persistent query that is
+    // registered on the first call and then updated by every insertion
+    // and removal of the listed components. Iterating it scans exactly
+    // the matching entities, and each() over the same terms uses it too.
+    template<typename... Terms>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    auto query() {
+        return componentManager_.template query<Terms...>()
             | std::ranges::views::transform(
-                [em=&entityManager_](size_t index) { return em->get(index); });
+                [em=entityManager_.get()](size_t index) {
+                    return em->get(index); });
+    }
+
+    // Calls func(entity, args...) for every entity matching the terms.
+    // A non-const component term stamps every visited component as
+    // changed, whether func writes it or not, so Changed<T> then matches
+    // all of them. Systems that only read a component must list it as
+    // const T to keep change detection meaningful.
+    template<typename... Terms, typename Func>
+    void each(Func&& func) {
+        rejectNodeWrites<Terms...>();
+        componentManager_.template each<Terms...>(
+            [this, &func](size_t index, auto&&... args) {
+                func(
+                    entityManager_->get(index),
+                    std::forward<decltype(args)>(args)...);
+            });
+    }
+
+    template<typename... Terms, typename Func>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void each(Tick since, Func&& func) {
+        rejectNodeWrites<Terms...>();
+        componentManager_.template each<Terms...>(
+            since,
+            [this, &func](size_t index, auto&&... args) {
+                func(
+                    entityManager_->get(index),
+                    std::forward<decltype(args)>(args)...);
+            });
+    }
+
+    // Packs the entities having all the components for each() over
+    // exactly these components. A component can be in a single group,
+    // returns false if one of them is in another group already.
+    template <typename... Components>
+    bool group() {
+        invalidateNodeOrder<Components...>();
+        return componentManager_.template group<Components...>();
+    }
+
+    // Reorders the components by compare(const T&, const T&), so that
+    // views and each() over the type visit them in that order.
+    // Not counted as a change. Grouped components keep the group order
+    // and return false.
+    template <typename Component, typename Compare>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    bool sort(Compare&& compare) {
+        assertSerial();
+        invalidateNodeOrder<Component>();
+        return componentManager_.template sort<Component>(
+            std::forward<Compare>(compare));
+    }
+
+    // Puts the components of the entities having Other first, in the
+    // order of Other, so that iterating both touches memory sequentially.
+    // Returns false for grouped components like sort().
+    template <typename Component, typename Other>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    bool sortAs() {
+        assertSerial();
+        invalidateNodeOrder<Component>();
+        return componentManager_.template sortAs<Component, Other>();
+    }
+
+    Tick tick() const noexcept
+        requires Internal::SparseSetBackend<ComponentBackend>
+    {
+        return componentManager_.tick();
+    }
+
+    // Ends the current tick and returns it, so a system can pass
+    // the result as since on its next run to see the later changes.
+    Tick advanceTick() noexcept
+        requires Internal::SparseSetBackend<ComponentBackend>
+    {
+        Tick ended = componentManager_.advanceTick();
+        entityManager_->setTick(tick());
+        return ended;
+    }
+
+    // Writes the entities with their generations, the tick and
+    // the listed components, see Serializer for the component format.
+    // Supported by the sparse-set backend.
+    template <typename... Components>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void save(SnapshotWriter& writer) const {
+        writer.write(Internal::kSnapshotMagic);
+        writer.write(Internal::kSnapshotVersion);
+        writer.write<uint64_t>(sizeof...(Components));
+        entityManager_->save(writer);
+        componentManager_.template save<Components...>(writer);
+    }
+
+    // Loads a snapshot saved with the same component list into a world
+    // without entities. Entities saved earlier stay valid. No signals
+    // are emitted. Malformed data leaves the world empty and
+    // returns false.
+    template <typename... Components>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    bool load(SnapshotReader& reader) {
+        assertSerial();
+        assert(entityManager_->empty());
+        if (reader.read<uint32_t>() != Internal::kSnapshotMagic
+            || reader.read<uint32_t>() != Internal::kSnapshotVersion
+            || reader.read<uint64_t>() != sizeof...(Components)
+            || !entityManager_->load(reader)
+        ) {
+            return false;
+        }
+        bool loaded = componentManager_.template load<Components...>(
+            reader,
+            [this](size_t index) { return entityManager_->contains(index); });
+        if (!loaded) {
+            entityManager_->clear();
+        }
+        entityManager_->setTick(tick());
+        hierarchy_.invalidate();
+        return loaded;
+    }
+
+    // Writes what changed after since: the created and destroyed
+    // entities, and per listed component the removed indices and
+    // the inserted or changed components. Applied to a world holding
+    // the state as of since, e.g. loaded from a snapshot saved before
+    // the advanceTick() that returned since, the delta brings it
+    // in sync. Supported by the sparse-set backend.
+    template <typename... Components>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    void saveDelta(SnapshotWriter& writer, Tick since) const {
+        writer.write(Internal::kDeltaMagic);
+        writer.write(Internal::kSnapshotVersion);
+        writer.write<uint64_t>(sizeof...(Components));
+        entityManager_->saveDelta(writer, since);
+        componentManager_.template saveDelta<Components...>(
+            writer, since,
+            [this](size_t index) { return entityManager_->contains(index); });
+    }
+
+    // Applies a delta saved with the same component list. The whole
+    // delta is read and checked first, malformed data returns false
+    // and leaves the world unchanged. Changes go through the regular
+    // paths: listeners are notified and components are stamped with
+    // the current tick.
+    template <typename... Components>
+        requires Internal::SparseSetBackend<ComponentBackend>
+    bool applyDelta(SnapshotReader& reader) {
+        assertSerial();
+        Internal::EntityDelta entities;
+        Internal::ComponentDelta<Components...> components;
+        if (reader.read<uint32_t>() != Internal::kDeltaMagic
+            || reader.read<uint32_t>() != Internal::kSnapshotVersion
+            || reader.read<uint64_t>() != sizeof...(Components)
+            || !entityManager_->readDelta(reader, entities)
+            || !componentManager_.template readDelta<Components...>(
+                reader,
+                [&entities](size_t index) {
+                    return entities.contains(index); },
+                components)
+        ) {
+            return false;
+        }
+        entityManager_->applyDelta(
+            entities,
+            [this](size_t index) {
+                hierarchy_.remove(componentManager_, index);
+                componentManager_.clearIndex(index); });
+        componentManager_.template applyDelta<Components...>(
+            std::move(components));
+        hierarchy_.invalidate();
+        return true;
+    }
+
+    // Parallel each(). func may only touch the components passed to it
+    // and must not change the entity structure until all chunks are
+    // done. Only debug builds check this, release builds do not.
+    template<typename... Terms, typename Func>
+    void parallelEach(Func&& func, size_t chunkSize = kDefaultChunkSize) {
+        rejectNodeWrites<Terms...>();
+        parallelDepth_->fetch_add(1, std::memory_order_relaxed);
+        componentManager_.template parallelEach<Terms...>(
+            *threadPool_, chunkSize,
+            [this, &func](size_t index, auto&&... args) {
+                func(
+                    entityManager_->get(index),
+                    std::forward<decltype(args)>(args)...);
+            });
+        parallelDepth_->fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void setWorkerCount(size_t count) {
+        assertSerial();
+        threadPool_->setWorkerCount(count);
     }
 
     void addLoopSystem(Closure&& system) noexcept {
         systemManager_.addLoop(std::move(system));
     }
 
+    // Loop system declaring its access with Read<...> and Write<...>.
+    // Consecutive scheduled systems run in parallel on the pool unless
+    // one writes what the other reads or writes, then in insertion order.
+    // They may only access the declared components of existing entities,
+    // structural changes are rejected by an assertion in debug builds.
+    template <typename... Access>
+    void addLoopSystem(Closure&& system) noexcept {
+        static_assert(sizeof...(Access) > 0);
+        (registerAccess(Access{}), ...);
+        systemManager_.addLoop(
+            Internal::SystemAccess::of<Access...>(),
+            std::move(system), *threadPool_);
+    }
+
     void addHeadCleanupSystem(Closure&& system) noexcept {
         systemManager_.addHead(std::move(system));
     }
@@ -103,9 +585,65 @@ public:
     }
 
 private:
-    Internal::EntityManager entityManager_;
-    Internal::ComponentManager componentManager_;
+    static constexpr size_t kDefaultChunkSize = 4096;
+
+    std::unique_ptr<Internal::ThreadPool> threadPool_ =
+        std::make_unique<Internal::ThreadPool>();
+    std::unique_ptr<std::atomic<size_t>> parallelDepth_ =
+        std::make_unique<std::atomic<size_t>>(0);
+    // Heap-held like the pool, listeners and views keep a pointer to it
+    // that survives moving the manager.
+    std::unique_ptr<Internal::EntityManager> entityManager_ =
+        std::make_unique<Internal::EntityManager>();
+    ComponentBackend componentManager_;
+    Internal::ResourceManager resourceManager_;
+    Internal::Hierarchy hierarchy_;
     Internal::SystemManager systemManager_;
+
+    // Structural changes are rejected in parallelEach() and scheduled
+    // systems by this assertion, so release builds do not check them.
+    void assertSerial() const noexcept {
+        assert(!parallelDepth_->load(std::memory_order_relaxed)
+            && !Internal::ParallelStage::isRunningSystem());
+    }
+
+    // HierarchyNode links are changed only through the hierarchy,
+    // const access is allowed.
+    template <typename... Components>
+    static constexpr void rejectNodeWrites() noexcept {
+        static_assert(
+            !(Internal::WritesNode<Components>::value || ...),
+            "HierarchyNode is changed by setParent() and removeParent()");
+    }
+
+    // The depth-first order of the nodes is rebuilt by the next pass
+    // after they are reordered bypassing the hierarchy.
+    template <typename... Components>
+    void invalidateNodeOrder() noexcept {
+        if constexpr ((std::is_same_v<Components, HierarchyNode> || ...)) {
+            hierarchy_.invalidate();
+        }
+    }
+
+    template <typename Func>
+    Internal::StorageSignals::Listener makeListener(Func&& func) {
+        return [em=entityManager_.get(), func=std::forward<Func>(func)](
+            size_t index
+        ) mutable noexcept {
+            func(em->get(index));
+        };
+    }
+
+    template <template <typename...> typename Term, typename... Components>
+    void registerAccess(Term<Components...>) noexcept {
+        (componentManager_.template registerComponent<Components>(), ...);
+    }
 };
 
+using ECSManager = BasicECSManager<Internal::ComponentManager>;
+using ArchetypeECSManager = BasicECSManager<Internal::ArchetypeManager>;
+
+using CommandBuffer = BasicCommandBuffer<ECSManager>;
+using ArchetypeCommandBuffer = BasicCommandBuffer<ArchetypeECSManager>;
+
 }  // namespace Istok::ECS
@@ -0,0 +1,677 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "term.hpp"
+#include "thread_pool.hpp"
+#include "type_id.hpp"
+
+namespace Istok::ECS::Internal {
+
+class AbstractColumn {
+public:
+    virtual ~AbstractColumn() = default;
+    virtual std::unique_ptr<AbstractColumn> makeEmpty() const = 0;
+    virtual void moveFrom(AbstractColumn& source, size_t row) noexcept = 0;
+    virtual void remove(size_t row) noexcept = 0;
+    virtual void clear() noexcept = 0;
+    virtual void reserve(size_t count) = 0;
+};
+
+template <typename T>
+class Column : public AbstractColumn {
+public:
+    Column() = default;
+
+    explicit Column(std::pmr::memory_resource* resource)
+    : values_(resource) {}
+
+    ~Column() = default;
+
+    Column(const Column&) = delete;
+    Column& operator=(const Column&) = delete;
+    Column(Column&&) = default;
+    Column& operator=(Column&&) = default;
+
+    size_t size() const noexcept {
+        return values_.size();
+    }
+
+    T& get(size_t row) noexcept {
+        assert(row < values_.size());
+        return values_[row];
+    }
+
+    void push(T&& value) noexcept {
+        values_.push_back(std::forward<T>(value));
+    }
+
+    std::unique_ptr<AbstractColumn> makeEmpty() const override {
+        return std::make_unique<Column<T>>(
+            values_.get_allocator().resource());
+    }
+
+    void moveFrom(AbstractColumn& source, size_t row) noexcept override {
+        push(std::move(static_cast<Column<T>&>(source).get(row)));
+    }
+
+    void remove(size_t row) noexcept override {
+        assert(row < values_.size());
+        if (row < values_.size() - 1) {
+            values_[row] = std::move(values_.back());
+        }
+        values_.pop_back();
+    }
+
+    void clear() noexcept override {
+        values_.clear();
+    }
+
+    // Room for count more rows, keeping the geometric growth.
+    void reserve(size_t count) override {
+        size_t required = values_.size() + count;
+        if (required > values_.capacity()) {
+            values_.reserve(std::max(required, 2 * values_.capacity()));
+        }
+    }
+
+private:
+    std::pmr::vector<T> values_;
+};
+
+
+// Table of all entities sharing the same component signature.
+// Components are stored column-wise, row r of every column belongs
+// to the entity with index indices()[r].
+class Archetype {
+public:
+    using Key = size_t;
+    using Signature = std::vector<Key>;
+
+    explicit Archetype(
+        Signature signature,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    : signature_(std::move(signature)), columns_(resource),
+        columnIndex_(resource), indices_(resource),
+        addEdges_(resource), removeEdges_(resource) {
+        assert(std::ranges::is_sorted(signature_));
+    }
+
+    ~Archetype() = default;
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+    Archetype(Archetype&&) = default;
+    Archetype& operator=(Archetype&&) = default;
+
+    const Signature& signature() const noexcept {
+        return signature_;
+    }
+
+    size_t size() const noexcept {
+        return indices_.size();
+    }
+
+    bool contains(Key key) const noexcept {
+        return key < columnIndex_.size() && columnIndex_[key] != kNoColumn;
+    }
+
+    std::span<const size_t> indices() const noexcept {
+        return std::span<const size_t>(indices_);
+    }
+
+    void addColumn(Key key, std::unique_ptr<AbstractColumn>&& column) {
+        assert(std::ranges::binary_search(signature_, key));
+        assert(!contains(key));
+        if (key >= columnIndex_.size()) {
+            columnIndex_.resize(key + 1, kNoColumn);
+        }
+        columnIndex_[key] = columns_.size();
+        columns_.push_back(std::move(column));
+    }
+
+    template <typename T>
+    Column<T>& column(Key key) noexcept {
+        assert(contains(key));
+        return static_cast<Column<T>&>(*columns_[columnIndex_[key]]);
+    }
+
+    AbstractColumn& column(Key key) noexcept {
+        assert(contains(key));
+        return *columns_[columnIndex_[key]];
+    }
+
+    std::unique_ptr<AbstractColumn> makeEmptyColumn(Key key) const {
+        assert(contains(key));
+        return columns_[columnIndex_[key]]->makeEmpty();
+    }
+
+    // Moves shared columns of the source row here, columns missing
+    // in the source are left for the caller to fill.
+    size_t moveFrom(Archetype& source, size_t row, size_t index) noexcept {
+        for (Key key : source.signature_) {
+            if (contains(key)) {
+                column(key).moveFrom(source.column(key), row);
+            }
+        }
+        indices_.push_back(index);
+        return indices_.size() - 1;
+    }
+
+    size_t push(size_t index) noexcept {
+        indices_.push_back(index);
+        return indices_.size() - 1;
+    }
+
+    // Returns the index of the entity moved into the removed row if any.
+    std::optional<size_t> remove(size_t row) noexcept {
+        assert(row < indices_.size());
+        for (auto& column : columns_) {
+            column->remove(row);
+        }
+        std::optional<size_t> moved;
+        if (row < indices_.size() - 1) {
+            indices_[row] = indices_.back();
+            moved = indices_[row];
+        }
+        indices_.pop_back();
+        return moved;
+    }
+
+    void clear() noexcept {
+        for (auto& column : columns_) {
+            column->clear();
+        }
+        indices_.clear();
+    }
+
+    void reserve(size_t count) {
+        for (auto& column : columns_) {
+            column->reserve(count);
+        }
+        size_t required = indices_.size() + count;
+        if (required > indices_.capacity()) {
+            indices_.reserve(std::max(required, 2 * indices_.capacity()));
+        }
+    }
+
+    Archetype* addEdge(Key key) const noexcept {
+        auto it = addEdges_.find(key);
+        return it != addEdges_.end() ? it->second : nullptr;
+    }
+
+    Archetype* removeEdge(Key key) const noexcept {
+        auto it = removeEdges_.find(key);
+        return it != removeEdges_.end() ? it->second : nullptr;
+    }
+
+    void setAddEdge(Key key, Archetype* target) {
+        addEdges_[key] = target;
+    }
+
+    void setRemoveEdge(Key key, Archetype* target) {
+        removeEdges_[key] = target;
+    }
+
+private:
+    static constexpr size_t kNoColumn = SIZE_MAX;
+
+    Signature signature_;
+    std::pmr::vector<std::unique_ptr<AbstractColumn>> columns_;
+    std::pmr::vector<size_t> columnIndex_;
+    std::pmr::vector<size_t> indices_;
+    std::pmr::unordered_map<Key, Archetype*> addEdges_;
+    std::pmr::unordered_map<Key, Archetype*> removeEdges_;
+};
+
+
+// Access to the columns behind a single view term.
+template <typename Component>
+class ArchetypeTerm {
+public:
+    static bool matches(const Archetype& archetype) noexcept {
+        return archetype.contains(typeId<Component>());
+    }
+
+    void bind(Archetype& archetype) noexcept {
+        column_ = &archetype.column<Component>(typeId<Component>());
+    }
+
+    std::tuple<Component&> args(size_t row) const noexcept {
+        return {column_->get(row)};
+    }
+
+private:
+    Column<Component>* column_ = nullptr;
+};
+
+// Read-only access, archetypes keep no change ticks to spare.
+template <typename Component>
+class ArchetypeTerm<const Component> {
+public:
+    static bool matches(const Archetype& archetype) noexcept {
+        return archetype.contains(typeId<Component>());
+    }
+
+    void bind(Archetype& archetype) noexcept {
+        column_ = &archetype.column<Component>(typeId<Component>());
+    }
+
+    std::tuple<const Component&> args(size_t row) const noexcept {
+        return {column_->get(row)};
+    }
+
+private:
+    Column<Component>* column_ = nullptr;
+};
+
+// Tick terms would match nothing, so they are rejected at compile time.
+template <typename Component>
+class ArchetypeTerm<Added<Component>> {
+    static_assert(
+        sizeof(Component) == 0, "Archetypes keep no change ticks");
+};
+
+template <typename Component>
+class ArchetypeTerm<Changed<Component>> {
+    static_assert(
+        sizeof(Component) == 0, "Archetypes keep no change ticks");
+};
+
+template <typename... Components>
+class ArchetypeTerm<Without<Components...>> {
+public:
+    static bool matches(const Archetype& archetype) noexcept {
+        return !(archetype.contains(typeId<Components>()) || ...);
+    }
+
+    void bind(Archetype&) noexcept {}
+
+    std::tuple<> args(size_t) const noexcept {
+        return {};
+    }
+};
+
+template <typename Component>
+class ArchetypeTerm<Optional<Component>> {
+public:
+    static bool matches(const Archetype&) noexcept {
+        return true;
+    }
+
+    void bind(Archetype& archetype) noexcept {
+        column_ = archetype.contains(typeId<Component>())
+            ? &archetype.column<T>(typeId<Component>())
+            : nullptr;
+    }
+
+    std::tuple<Component*> args(size_t row) const noexcept {
+        return {column_ ? &column_->get(row) : nullptr};
+    }
+
+private:
+    using T = std::remove_const_t<Component>;
+
+    Column<T>* column_ = nullptr;
+};
+
+
+// Component backend storing entities with equal component sets together.
+// Interface mirrors ComponentManager so it can be plugged into
+// BasicECSManager. Inserting or removing a component moves the entity
+// to another archetype, so unlike the sparse-set backend any structural
+// change invalidates running views. Lifecycle signals, change ticks,
+// cached queries, sorting and the hierarchy are not supported.
+class ArchetypeManager {
+public:
+    ArchetypeManager() = default;
+
+    // Columns, rows, archetype edges and entity locations are allocated
+    // from the resource, which must outlive the manager.
+    explicit ArchetypeManager(std::pmr::memory_resource* resource)
+    : archetypes_(resource), locations_(resource) {}
+
+    ~ArchetypeManager() = default;
+
+    ArchetypeManager(const ArchetypeManager&) = delete;
+    ArchetypeManager& operator=(const ArchetypeManager&) = delete;
+    ArchetypeManager(ArchetypeManager&&) noexcept = default;
+    ArchetypeManager& operator=(ArchetypeManager&&) noexcept = default;
+
+    template <typename Component>
+    bool has(size_t index) const noexcept {
+        Archetype* archetype = locate(index).archetype;
+        return archetype && archetype->contains(key<Component>());
+    }
+
+    template <typename Component>
+    size_t count() const noexcept {
+        size_t result = 0;
+        for (const auto& archetype : archetypes_) {
+            if (archetype->contains(key<Component>())) {
+                result += archetype->size();
+            }
+        }
+        return result;
+    }
+
+    // A const component yields a read-only reference to the same column.
+    template <typename Component>
+    Component& get(size_t index) noexcept {
+        using T = std::remove_cvref_t<Component>;
+        assert(has<T>(index));
+        const Location& location = locations_[index];
+        return location.archetype->column<T>(key<T>()).get(location.row);
+    }
+
+    template <typename Component>
+    void insert(size_t index, Component&& value) noexcept {
+        if (has<Component>(index)) {
+            get<Component>(index) = std::forward<Component>(value);
+            return;
+        }
+        if (index >= locations_.size()) {
+            locations_.resize(index + 1);
+        }
+        auto k = key<Component>();
+        Location& location = locations_[index];
+        Archetype& target = addTarget(
+            location.archetype, k, [this] {
+                return std::make_unique<Column<Component>>(resource()); });
+        moveRow(index, target);
+        target.column<Component>(k).push(std::forward<Component>(value));
+    }
+
+    // Rows are counted per target archetype first, so that every
+    // target reserves its columns once before the rows move in.
+    template <typename Component, typename Values>
+    void insertRange(std::span<const size_t> indices, Values&& values) {
+        auto k = key<Component>();
+        std::unordered_map<Archetype*, size_t> targets;
+        for (size_t index : indices) {
+            if (has<Component>(index)) {
+                continue;
+            }
+            Archetype* source = index < locations_.size()
+                ? locations_[index].archetype : nullptr;
+            ++targets[&addTarget(source, k, [this] {
+                return std::make_unique<Column<Component>>(resource()); })];
+        }
+        for (auto [target, count] : targets) {
+            target->reserve(count);
+        }
+        auto value = std::ranges::begin(values);
+        for (size_t index : indices) {
+            if constexpr (std::is_lvalue_reference_v<Values>) {
+                insert(index, Component(*value));
+            } else {
+                insert(index, Component(std::ranges::iter_move(value)));
+            }
+            ++value;
+        }
+    }
+
+    template <typename Component>
+    void remove(size_t index) noexcept {
+        assert(has<Component>(index));
+        Archetype* target = removeTarget(
+            *locations_[index].archetype, key<Component>());
+        if (target) {
+            moveRow(index, *target);
+        } else {
+            clearIndex(index);
+        }
+    }
+
+    template <typename Component>
+    void removeAll() noexcept {
+        auto k = key<Component>();
+        // Archetypes may be created while moving rows.
+        const size_t archetypeCount = archetypes_.size();
+        for (size_t i = 0; i < archetypeCount; ++i) {
+            Archetype& source = *archetypes_[i];
+            if (!source.contains(k) || source.size() == 0) {
+                continue;
+            }
+            Archetype* target = removeTarget(source, k);
+            if (!target) {
+                for (size_t index : source.indices()) {
+                    locations_[index] = Location{};
+                }
+                source.clear();
+                continue;
+            }
+            while (source.size() > 0) {
+                moveRow(source.indices().back(), *target);
+            }
+        }
+    }
+
+    // Iteration never creates archetypes, nothing to prepare.
+    template <typename Component>
+    void registerComponent() noexcept {}
+
+    // Archetype columns are packed already.
+    template <typename... Components>
+    bool group() noexcept {
+        return true;
+    }
+
+    // The target archetypes are only known per row.
+    template <typename Component>
+    void reserve(size_t) noexcept {}
+
+    void clearIndex(size_t index) noexcept {
+        if (index >= locations_.size() || !locations_[index].archetype) {
+            return;
+        }
+        Location& location = locations_[index];
+        auto moved = location.archetype->remove(location.row);
+        if (moved) {
+            locations_[*moved].row = location.row;
+        }
+        location = Location{};
+    }
+
+    void clear() noexcept {
+        locations_.clear();
+        bySignature_.clear();
+        archetypes_.clear();
+    }
+
+    template<typename... Terms>
+    auto view() noexcept {
+        return std::ranges::views::all(archetypes_)
+            | std::ranges::views::filter(
+                [](const std::unique_ptr<Archetype>& archetype) {
+                    return (ArchetypeTerm<Terms>::matches(*archetype) && ...);
+                })
+            | std::ranges::views::transform(
+                [](const std::unique_ptr<Archetype>& archetype) {
+                    return archetype->indices(); })
+            | std::ranges::views::join
+            | std::ranges::views::common;
+    }
+
+    // Walks matching archetypes row by row. func must not change
+    // the component set of any entity while iterating.
+    template<typename... Terms, typename Func>
+    void each(Func&& func) {
+        for (auto& archetype : archetypes_) {
+            if (!(ArchetypeTerm<Terms>::matches(*archetype) && ...)) {
+                continue;
+            }
+            std::tuple<ArchetypeTerm<Terms>...> terms;
+            std::apply(
+                [&archetype](auto&... term) { (term.bind(*archetype), ...); },
+                terms);
+            auto indices = archetype->indices();
+            for (size_t row = 0; row < indices.size(); ++row) {
+                std::apply(
+                    func,
+                    std::apply(
+                        [&indices, row](const auto&... term) {
+                            return std::tuple_cat(
+                                std::tuple<size_t>(indices[row]),
+                                term.args(row)...);
+                        },
+                        terms));
+            }
+        }
+    }
+
+    // Runs each() over row chunks of the matching archetypes on the pool.
+    template<typename... Terms, typename Func>
+    void parallelEach(ThreadPool& pool, size_t chunkSize, Func&& func) {
+        TaskGroup group;
+        for (auto& archetype : archetypes_) {
+            if (!(ArchetypeTerm<Terms>::matches(*archetype) && ...)) {
+                continue;
+            }
+            std::tuple<ArchetypeTerm<Terms>...> terms;
+            std::apply(
+                [&archetype](auto&... term) { (term.bind(*archetype), ...); },
+                terms);
+            auto indices = archetype->indices();
+            for (size_t begin = 0; begin < indices.size(); begin += chunkSize) {
+                size_t end = std::min(begin + chunkSize, indices.size());
+                pool.submit(
+                    group,
+                    [&func, terms, indices, begin, end]() noexcept {
+                        for (size_t row = begin; row < end; ++row) {
+                            std::apply(
+                                func,
+                                std::apply(
+                                    [&indices, row](const auto&... term) {
+                                        return std::tuple_cat(
+                                            std::tuple<size_t>(indices[row]),
+                                            term.args(row)...);
+                                    },
+                                    terms));
+                        }
+                    });
+            }
+        }
+        pool.wait(group);
+    }
+
+private:
+    struct Location {
+        Archetype* archetype = nullptr;
+        size_t row = 0;
+    };
+
+    std::pmr::vector<std::unique_ptr<Archetype>> archetypes_;
+    std::map<Archetype::Signature, Archetype*> bySignature_;
+    std::pmr::vector<Location> locations_;
+
+    template <typename Component>
+    static Archetype::Key key() noexcept {
+        return typeId<Component>();
+    }
+
+    std::pmr::memory_resource* resource() const noexcept {
+        return archetypes_.get_allocator().resource();
+    }
+
+    Location locate(size_t index) const noexcept {
+        return index < locations_.size() ? locations_[index] : Location{};
+    }
+
+    template <typename MakeColumn>
+    Archetype& addTarget(
+        Archetype* source, Archetype::Key k, MakeColumn&& makeColumn
+    ) {
+        if (source) {
+            if (Archetype* target = source->addEdge(k)) {
+                return *target;
+            }
+        }
+        Archetype::Signature signature;
+        if (source) {
+            signature = source->signature();
+        }
+        signature.insert(std::ranges::upper_bound(signature, k), k);
+        Archetype* target = findArchetype(signature);
+        if (!target) {
+            target = &createArchetype(signature);
+            if (source) {
+                for (Archetype::Key sk : source->signature()) {
+                    target->addColumn(sk, source->makeEmptyColumn(sk));
+                }
+            }
+            target->addColumn(k, makeColumn());
+        }
+        if (source) {
+            source->setAddEdge(k, target);
+            target->setRemoveEdge(k, source);
+        }
+        return *target;
+    }
+
+    Archetype* removeTarget(Archetype& source, Archetype::Key k) {
+        if (source.signature().size() == 1) {
+            return nullptr;
+        }
+        if (Archetype* target = source.removeEdge(k)) {
+            return target;
+        }
+        Archetype::Signature signature = source.signature();
+        std::erase(signature, k);
+        Archetype* target = findArchetype(signature);
+        if (!target) {
+            target = &createArchetype(signature);
+            for (Archetype::Key sk : signature) {
+                target->addColumn(sk, source.makeEmptyColumn(sk));
+            }
+        }
+        source.setRemoveEdge(k, target);
+        target->setAddEdge(k, &source);
+        return target;
+    }
+
+    Archetype* findArchetype(const Archetype::Signature& signature) {
+        auto it = bySignature_.find(signature);
+        return it != bySignature_.end() ? it->second : nullptr;
+    }
+
+    Archetype& createArchetype(const Archetype::Signature& signature) {
+        archetypes_.push_back(
+            std::make_unique<Archetype>(signature, resource()));
+        Archetype& archetype = *archetypes_.back();
+        bySignature_.emplace(signature, &archetype);
+        return archetype;
+    }
+
+    void moveRow(size_t index, Archetype& target) noexcept {
+        Location& location = locations_[index];
+        if (!location.archetype) {
+            location = Location{&target, target.push(index)};
+            return;
+        }
+        Archetype& source = *location.archetype;
+        size_t row = location.row;
+        size_t newRow = target.moveFrom(source, row, index);
+        auto moved = source.remove(row);
+        if (moved) {
+            locations_[*moved].row = row;
+        }
+        location = Location{&target, newRow};
+    }
+};
+
+}  // namespace Istok::ECS::Internal
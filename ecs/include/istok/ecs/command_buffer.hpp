@@ -0,0 +1,213 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "entity.hpp"
+#include "type_id.hpp"
+
+namespace Istok::ECS {
+
+// Structural changes recorded from any thread and applied at once.
+// apply() creates the entities, replays the component operations type
+// by type and then removes the entities. Operations on the same entity
+// and component take effect in the recording order, removeAll() drops
+// the ones recorded before it. Within a component type the entities are
+// visited by index and the storage is reserved once. Operations on
+// invalid entities and removal of absent components are ignored.
+template <typename Manager>
+class BasicCommandBuffer {
+public:
+    // Entity that will be created by apply().
+    class PendingEntity {
+    public:
+        size_t id() const noexcept {
+            return id_;
+        }
+
+    private:
+        friend class BasicCommandBuffer;
+        size_t id_;
+
+        explicit PendingEntity(size_t id) noexcept : id_(id) {}
+    };
+
+    BasicCommandBuffer() = default;
+    ~BasicCommandBuffer() = default;
+
+    BasicCommandBuffer(const BasicCommandBuffer&) = delete;
+    BasicCommandBuffer& operator=(const BasicCommandBuffer&) = delete;
+    BasicCommandBuffer(BasicCommandBuffer&&) = delete;
+    BasicCommandBuffer& operator=(BasicCommandBuffer&&) = delete;
+
+    bool empty() const noexcept {
+        std::lock_guard lock(mutex_);
+        return createCount_ == 0 && batches_.empty()
+            && entityRemovals_.empty();
+    }
+
+    PendingEntity createEntity() noexcept {
+        std::lock_guard lock(mutex_);
+        return PendingEntity(createCount_++);
+    }
+
+    void removeEntity(Entity entity) {
+        std::lock_guard lock(mutex_);
+        entityRemovals_.push_back(entity);
+    }
+
+    template <typename Component>
+    void insert(Entity entity, Component&& component) {
+        std::lock_guard lock(mutex_);
+        ensureBatch<Component>().operations.emplace_back(
+            entity, std::forward<Component>(component));
+    }
+
+    template <typename Component>
+    void insert(PendingEntity entity, Component&& component) {
+        std::lock_guard lock(mutex_);
+        assert(entity.id_ < createCount_);
+        ensureBatch<Component>().operations.emplace_back(
+            entity, std::forward<Component>(component));
+    }
+
+    template <typename Component>
+    void remove(Entity entity) {
+        std::lock_guard lock(mutex_);
+        ensureBatch<Component>().operations.emplace_back(
+            entity, std::nullopt);
+    }
+
+    template <typename Component>
+    void removeAll() {
+        std::lock_guard lock(mutex_);
+        auto& batch = ensureBatch<Component>();
+        batch.removeAll = true;
+        batch.operations.clear();
+    }
+
+    // Returns the created entities in the order of createEntity() calls
+    // and leaves the buffer empty.
+    std::vector<Entity> apply(Manager& ecs) {
+        std::vector<std::unique_ptr<AbstractBatch>> batches;
+        std::vector<Entity> entityRemovals;
+        size_t createCount;
+        {
+            std::lock_guard lock(mutex_);
+            batches = std::exchange(batches_, {});
+            entityRemovals = std::exchange(entityRemovals_, {});
+            createCount = std::exchange(createCount_, 0);
+        }
+        std::vector<Entity> created;
+        created.reserve(createCount);
+        for (size_t i = 0; i < createCount; ++i) {
+            created.push_back(ecs.createEntity());
+        }
+        for (auto& batch : batches) {
+            if (batch) {
+                batch->apply(ecs, created);
+            }
+        }
+        for (Entity entity : entityRemovals) {
+            if (ecs.isValidEntity(entity)) {
+                ecs.removeEntity(entity);
+            }
+        }
+        return created;
+    }
+
+private:
+    using Target = std::variant<Entity, PendingEntity>;
+
+    class AbstractBatch {
+    public:
+        virtual ~AbstractBatch() = default;
+        virtual void apply(
+            Manager& ecs, std::span<const Entity> created) = 0;
+    };
+
+    template <typename Component>
+    class Batch : public AbstractBatch {
+    public:
+        bool removeAll = false;
+        // Insertions and removals, the latter without a component.
+        std::vector<std::pair<Target, std::optional<Component>>> operations;
+
+        // Only the last operation on an entity has an effect. Positions
+        // are sorted rather than the components themselves, equal
+        // indices keep the recording order.
+        void apply(Manager& ecs, std::span<const Entity> created) override {
+            if (removeAll) {
+                ecs.template removeAll<Component>();
+            }
+            std::vector<Entity> entities;
+            entities.reserve(operations.size());
+            for (const auto& operation : operations) {
+                entities.push_back(resolve(operation.first, created));
+            }
+            std::vector<size_t> order(operations.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::ranges::stable_sort(
+                order, {}, [&entities](size_t i) {
+                    return entities[i].index(); });
+            ecs.template reserve<Component>(std::ranges::count_if(
+                operations, [](const auto& operation) {
+                    return operation.second.has_value(); }));
+            for (size_t k = 0; k < order.size(); ++k) {
+                Entity entity = entities[order[k]];
+                auto& component = operations[order[k]].second;
+                bool overridden = k + 1 < order.size()
+                    && entities[order[k + 1]] == entity;
+                if (overridden || !ecs.isValidEntity(entity)) {
+                    continue;
+                }
+                if (component) {
+                    ecs.insert(entity, std::move(*component));
+                } else if (ecs.template has<Component>(entity)) {
+                    ecs.template remove<Component>(entity);
+                }
+            }
+        }
+
+    private:
+        static Entity resolve(
+            const Target& target, std::span<const Entity> created
+        ) noexcept {
+            if (auto pending = std::get_if<PendingEntity>(&target)) {
+                return created[pending->id()];
+            }
+            return std::get<Entity>(target);
+        }
+    };
+
+    mutable std::mutex mutex_;
+    size_t createCount_ = 0;
+    std::vector<std::unique_ptr<AbstractBatch>> batches_;
+    std::vector<Entity> entityRemovals_;
+
+    template <typename Component>
+    Batch<std::remove_cvref_t<Component>>& ensureBatch() {
+        using Stored = std::remove_cvref_t<Component>;
+        size_t id = Internal::typeId<Stored>();
+        if (id >= batches_.size()) {
+            batches_.resize(id + 1);
+        }
+        if (!batches_[id]) {
+            batches_[id] = std::make_unique<Batch<Stored>>();
+        }
+        return static_cast<Batch<Stored>&>(*batches_[id]);
+    }
+};
+
+}  // namespace Istok::ECS
@@ -1,227 +1,2326 @@
 // Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <span>
-#include <unordered_map>
-#include <typeindex>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <ranges>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
+#include "snapshot.hpp"
+#include "term.hpp"
+#include "thread_pool.hpp"
+#include "type_id.hpp"
+
+namespace Istok::ECS {
+
+// Storage policy of a component type. Specialize as std::true_type
+// to keep the components at fixed addresses while they exist, e.g. to
+// hold references to them without wrapping them in unique_ptr.
+template <typename T>
+struct StableComponent : std::false_type {};
+
+}  // namespace Istok::ECS
+
+
 namespace Istok::ECS::Internal {
 
-class AbstractComponentStorage {
+// Index to dense position map split into fixed-size pages.
+// Pages are allocated on first write, untouched ranges share
+// a single read-only page filled with kEmpty.
+class SparseIndex {
+public:
+    static constexpr int32_t kEmpty = -1;
+    static constexpr size_t kPageSize = 1024;
+
+    SparseIndex() = default;
+
+    explicit SparseIndex(std::pmr::memory_resource* resource)
+    : pages_(resource) {}
+
+    ~SparseIndex() {
+        clear();
+    }
+
+    SparseIndex(const SparseIndex&) = delete;
+    SparseIndex& operator=(const SparseIndex&) = delete;
+
+    SparseIndex(SparseIndex&& other) noexcept
+    : pages_(std::move(other.pages_)) {
+        other.pages_.clear();
+    }
+
+    // Pages of another resource are copied rather than adopted.
+    SparseIndex& operator=(SparseIndex&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        if (pages_.get_allocator() == other.pages_.get_allocator()) {
+            pages_ = std::move(other.pages_);
+        } else {
+            for (size_t page = 0; page < other.pages_.size(); ++page) {
+                if (other.pages_[page] != emptyPage()) {
+                    copyPage(page, *other.pages_[page]);
+                }
+            }
+            other.clear();
+        }
+        other.pages_.clear();
+        return *this;
+    }
+
+    int32_t get(size_t index) const noexcept {
+        size_t page = index / kPageSize;
+        return page < pages_.size()
+            ? (*pages_[page])[index % kPageSize]
+            : kEmpty;
+    }
+
+    void set(size_t index, int32_t value) {
+        size_t page = index / kPageSize;
+        if (page >= pages_.size()) {
+            pages_.resize(page + 1, emptyPage());
+        }
+        if (pages_[page] == emptyPage()) {
+            copyPage(page, *emptyPage());
+        }
+        (*pages_[page])[index % kPageSize] = value;
+    }
+
+    void reset(size_t index) noexcept {
+        assert(index / kPageSize < pages_.size());
+        assert(pages_[index / kPageSize] != emptyPage());
+        (*pages_[index / kPageSize])[index % kPageSize] = kEmpty;
+    }
+
+    void clear() noexcept {
+        std::pmr::polymorphic_allocator<Page> allocator =
+            pages_.get_allocator();
+        for (Page* page : pages_) {
+            if (page != emptyPage()) {
+                allocator.deallocate(page, 1);
+            }
+        }
+        pages_.clear();
+    }
+
+private:
+    using Page = std::array<int32_t, kPageSize>;
+
+    std::pmr::vector<Page*> pages_;
+
+    static Page* emptyPage() noexcept {
+        static Page page = [] {
+            Page result;
+            result.fill(kEmpty);
+            return result;
+        }();
+        return &page;
+    }
+
+    void copyPage(size_t page, const Page& source) {
+        if (page >= pages_.size()) {
+            pages_.resize(page + 1, emptyPage());
+        }
+        std::pmr::polymorphic_allocator<Page> allocator =
+            pages_.get_allocator();
+        pages_[page] = allocator.allocate(1);
+        std::ranges::copy(source, pages_[page]->begin());
+    }
+};
+
+
+// Owning group notified about structural changes of its storages.
+class AbstractGroup {
+public:
+    virtual ~AbstractGroup() = default;
+    virtual size_t size() const noexcept = 0;
+    virtual size_t ownedCount() const noexcept = 0;
+    virtual void onInsert(size_t index) noexcept = 0;
+    virtual void onRemove(size_t index) noexcept = 0;
+    virtual void onClear() noexcept = 0;
+};
+
+
+// Listeners of the component lifecycle in one storage, called with
+// the entity index. Construction is reported after insertion, update
+// after replacement and destruction before removal. Listeners must not
+// change the entity structure.
+struct StorageSignals {
+    using Listener = std::move_only_function<void(size_t index) noexcept>;
+
+    std::vector<Listener> construct;
+    std::vector<Listener> update;
+    std::vector<Listener> destroy;
+
+    static void emit(
+        std::vector<Listener>& listeners, size_t index
+    ) noexcept {
+        if (!listeners.empty()) [[unlikely]] {
+            for (auto& listener : listeners) {
+                listener(index);
+            }
+        }
+    }
+};
+
+
+// Random access stand-in for components addressed through slot pointers.
+template <typename T>
+class SlotComponents {
+public:
+    SlotComponents(T* const* slots, size_t size) noexcept
+    : slots_(slots), size_(size) {}
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    T& operator[](size_t position) const noexcept {
+        return *slots_[position];
+    }
+
+private:
+    T* const* slots_;
+    size_t size_;
+};
+
+// Components constructed in pages of about kPageBytes and never moved.
+// Dense positions refer to them through a slot pointer table,
+// the slots of removed components are reused by later insertions.
+template <typename T>
+class PagedComponents {
+public:
+    static constexpr size_t kPageBytes = 16 * 1024;
+    static constexpr size_t kPageSize =
+        std::max<size_t>(1, kPageBytes / sizeof(T));
+
+    PagedComponents() = default;
+
+    explicit PagedComponents(std::pmr::memory_resource* resource)
+    : slots_(resource), free_(resource), pages_(resource) {}
+
+    ~PagedComponents() {
+        clear();
+    }
+
+    PagedComponents(const PagedComponents&) = delete;
+    PagedComponents& operator=(const PagedComponents&) = delete;
+
+    PagedComponents(PagedComponents&& other) noexcept
+    : slots_(std::move(other.slots_)), free_(std::move(other.free_)),
+        pages_(std::move(other.pages_)), used_(other.used_) {
+        other.slots_.clear();
+        other.free_.clear();
+        other.pages_.clear();
+    }
+
+    PagedComponents& operator=(PagedComponents&&) = delete;
+
+    size_t size() const noexcept {
+        return slots_.size();
+    }
+
+    bool empty() const noexcept {
+        return slots_.empty();
+    }
+
+    size_t capacity() const noexcept {
+        return slots_.capacity();
+    }
+
+    void reserve(size_t count) {
+        slots_.reserve(count);
+    }
+
+    T& operator[](size_t position) noexcept {
+        return *slots_[position];
+    }
+
+    const T& operator[](size_t position) const noexcept {
+        return *slots_[position];
+    }
+
+    // The slot table grows first, so that a slot taken for
+    // the component is either filled or released.
+    void push_back(T&& value) {
+        if (slots_.size() == slots_.capacity()) {
+            slots_.reserve(std::max<size_t>(1, 2 * slots_.capacity()));
+        }
+        T* slot = acquire();
+        try {
+            std::construct_at(slot, std::move(value));
+        } catch (...) {
+            release(slot);
+            throw;
+        }
+        slots_.push_back(slot);
+    }
+
+    // Destroys the component and moves the last slot pointer
+    // to its position.
+    void swapRemove(size_t position) noexcept {
+        std::destroy_at(slots_[position]);
+        free_.push_back(slots_[position]);
+        slots_[position] = slots_.back();
+        slots_.pop_back();
+    }
+
+    void swapSlots(size_t a, size_t b) noexcept {
+        std::swap(slots_[a], slots_[b]);
+    }
+
+    SlotComponents<T> first(size_t count) noexcept {
+        return SlotComponents<T>(slots_.data(), count);
+    }
+
+    SlotComponents<const T> first(size_t count) const noexcept {
+        return SlotComponents<const T>(slots_.data(), count);
+    }
+
+    void clear() noexcept {
+        for (T* slot : slots_) {
+            std::destroy_at(slot);
+        }
+        std::pmr::polymorphic_allocator<T> allocator = pages_.get_allocator();
+        for (T* page : pages_) {
+            allocator.deallocate(page, kPageSize);
+        }
+        slots_.clear();
+        free_.clear();
+        pages_.clear();
+        used_ = 0;
+    }
+
+private:
+    std::pmr::vector<T*> slots_;
+    std::pmr::vector<T*> free_;
+    std::pmr::vector<T*> pages_;
+    size_t used_ = 0;
+
+    T* acquire() {
+        if (!free_.empty()) {
+            T* slot = free_.back();
+            free_.pop_back();
+            return slot;
+        }
+        if (pages_.empty() || used_ == kPageSize) {
+            std::pmr::polymorphic_allocator<T> allocator =
+                pages_.get_allocator();
+            if (pages_.size() == pages_.capacity()) {
+                pages_.reserve(std::max<size_t>(1, 2 * pages_.capacity()));
+            }
+            pages_.push_back(allocator.allocate(kPageSize));
+            used_ = 0;
+        }
+        return pages_.back() + used_++;
+    }
+
+    // Gives back a slot of acquire() left unconstructed. A slot taken
+    // from the free list fits there again without allocating.
+    void release(T* slot) noexcept {
+        if (slot == pages_.back() + used_ - 1) {
+            --used_;
+        } else {
+            free_.push_back(slot);
+        }
+    }
+};
+
+
+class AbstractComponentStorage {
+public:
+    virtual ~AbstractComponentStorage() = default;
+    virtual void removeIfHas(size_t index) noexcept = 0;
+    virtual void setTick(Tick tick) noexcept = 0;
+};
+
+// Dense components with the ticks of their insertion and last change.
+// Any mutable access counts as a change at the current tick. The change
+// ticks are stamped and read atomically, so systems sharing read access
+// stay race-free even if they take mutable references.
+// Stable components are paged, only their slot pointers are reordered.
+template <typename T>
+class ComponentStorage : public AbstractComponentStorage {
+    static constexpr bool kStable = StableComponent<T>::value;
+
+public:
+    ComponentStorage() = default;
+
+    explicit ComponentStorage(std::pmr::memory_resource* resource)
+    : indexToComponent_(resource), components_(resource),
+        componentToIndex_(resource), added_(resource), changed_(resource) {}
+
+    ~ComponentStorage() = default;
+
+    ComponentStorage(const ComponentStorage&) = delete;
+    ComponentStorage& operator=(const ComponentStorage&) = delete;
+    ComponentStorage(ComponentStorage&&) = default;
+    ComponentStorage& operator=(ComponentStorage&&) = default;
+
+    size_t size() const noexcept {
+        return components_.size();
+    }
+
+    bool has(size_t index) const noexcept {
+        return indexToComponent_.get(index) >= 0;
+    }
+
+    T& get(size_t index) noexcept {
+        assert(has(index));
+        size_t position = indexToComponent_.get(index);
+        stamp(position);
+        return components_[position];
+    }
+
+    const T& get(size_t index) const noexcept {
+        assert(has(index));
+        return components_[indexToComponent_.get(index)];
+    }
+
+    T* find(size_t index) noexcept {
+        int32_t position = indexToComponent_.get(index);
+        if (position < 0) {
+            return nullptr;
+        }
+        stamp(position);
+        return &components_[position];
+    }
+
+    const T* find(size_t index) const noexcept {
+        int32_t position = indexToComponent_.get(index);
+        return position >= 0 ? &components_[position] : nullptr;
+    }
+
+    size_t position(size_t index) const noexcept {
+        assert(has(index));
+        return indexToComponent_.get(index);
+    }
+
+    Tick addedTick(size_t index) const noexcept {
+        assert(has(index));
+        return added_[indexToComponent_.get(index)];
+    }
+
+    Tick changedTick(size_t index) const noexcept {
+        assert(has(index));
+        return std::atomic_ref<Tick>(
+            const_cast<Tick&>(changed_[indexToComponent_.get(index)]))
+            .load(std::memory_order_relaxed);
+    }
+
+    void setTick(Tick tick) noexcept override {
+        tick_ = tick;
+    }
+
+    void insert(size_t index, T&& value) noexcept {
+        if (has(index)) {
+            get(index) = std::forward<T>(value);
+            StorageSignals::emit(signals_.update, index);
+            return;
+        }
+        indexToComponent_.set(index, components_.size());
+        components_.push_back(std::forward<T>(value));
+        componentToIndex_.push_back(index);
+        added_.push_back(tick_);
+        changed_.push_back(tick_);
+        if (group_) {
+            group_->onInsert(index);
+        }
+        StorageSignals::emit(signals_.construct, index);
+    }
+
+    // Inserts values[i] into indices[i]. New components are appended
+    // as one block and indexed in the same pass, the group and the
+    // construct listeners see them once the block is complete.
+    // A repeated index keeps its last value.
+    template <typename Values>
+    void insertRange(std::span<const size_t> indices, Values&& values) {
+        reserve(indices.size());
+        const size_t begin = components_.size();
+        auto value = std::ranges::begin(values);
+        auto take = [&value]() -> T {
+            if constexpr (std::is_lvalue_reference_v<Values>) {
+                return *value;
+            } else {
+                return std::ranges::iter_move(value);
+            }
+        };
+        for (size_t index : indices) {
+            int32_t position = indexToComponent_.get(index);
+            if (position < 0) {
+                indexToComponent_.set(index, components_.size());
+                components_.push_back(take());
+                componentToIndex_.push_back(index);
+            } else if (static_cast<size_t>(position) >= begin) {
+                components_[position] = take();
+            } else {
+                stamp(position);
+                components_[position] = take();
+                StorageSignals::emit(signals_.update, index);
+            }
+            ++value;
+        }
+        const size_t end = components_.size();
+        added_.resize(end, tick_);
+        changed_.resize(end, tick_);
+        if (!group_) {
+            for (size_t position = begin; position < end; ++position) {
+                StorageSignals::emit(
+                    signals_.construct, componentToIndex_[position]);
+            }
+            return;
+        }
+        // The group swaps the appended positions.
+        std::vector<size_t> appended(
+            componentToIndex_.begin() + begin, componentToIndex_.end());
+        for (size_t index : appended) {
+            group_->onInsert(index);
+            StorageSignals::emit(signals_.construct, index);
+        }
+    }
+
+    // Keeps the geometric growth when called before every batch.
+    void reserve(size_t count) {
+        size_t required = components_.size() + count;
+        if (required > components_.capacity()) {
+            size_t capacity = std::max(required, 2 * components_.capacity());
+            components_.reserve(capacity);
+            componentToIndex_.reserve(capacity);
+            added_.reserve(capacity);
+            changed_.reserve(capacity);
+        }
+    }
+
+    void remove(size_t index) noexcept {
+        assert(has(index));
+        StorageSignals::emit(signals_.destroy, index);
+        if (group_) {
+            group_->onRemove(index);
+        }
+        size_t componentIndex = indexToComponent_.get(index);
+        if (componentIndex < components_.size() - 1) {
+            indexToComponent_.set(componentToIndex_.back(), componentIndex);
+            if constexpr (!kStable) {
+                components_[componentIndex] = std::move(components_.back());
+            }
+            componentToIndex_[componentIndex] = componentToIndex_.back();
+            added_[componentIndex] = added_.back();
+            changed_[componentIndex] = changed_.back();
+        }
+        indexToComponent_.reset(index);
+        if constexpr (kStable) {
+            components_.swapRemove(componentIndex);
+        } else {
+            components_.pop_back();
+        }
+        componentToIndex_.pop_back();
+        added_.pop_back();
+        changed_.pop_back();
+    }
+
+    void clear() noexcept {
+        clear([](size_t) {});
+    }
+
+    // Calls onRemove(index) for every component after its destruction
+    // has been signalled.
+    template <typename Func>
+    void clear(Func&& onRemove) noexcept {
+        for (size_t index : componentToIndex_) {
+            StorageSignals::emit(signals_.destroy, index);
+            onRemove(index);
+        }
+        if (group_) {
+            group_->onClear();
+        }
+        indexToComponent_.clear();
+        components_.clear();
+        componentToIndex_.clear();
+        added_.clear();
+        changed_.clear();
+    }
+
+    void removeIfHas(size_t index) noexcept override {
+        if (has(index)) {
+            remove(index);
+        }
+    }
+
+    std::span<const size_t> indices() const noexcept {
+        return std::span<const size_t>(componentToIndex_);
+    }
+
+    // Marks every component changed.
+    auto components() noexcept {
+        return components(components_.size());
+    }
+
+    auto components() const noexcept {
+        return first(components_.size());
+    }
+
+    // Marks the first count components changed.
+    auto components(size_t count) noexcept {
+        assert(count <= components_.size());
+        for (size_t position = 0; position < count; ++position) {
+            stamp(position);
+        }
+        return first(count);
+    }
+
+    // Marks the components in [begin, end) changed, the view covers
+    // the first end ones. Lets parallel chunks stamp their own part.
+    auto components(size_t begin, size_t end) noexcept {
+        assert(begin <= end && end <= components_.size());
+        for (size_t position = begin; position < end; ++position) {
+            stamp(position);
+        }
+        return first(end);
+    }
+
+    void swapDense(size_t a, size_t b) noexcept {
+        if (a == b) {
+            return;
+        }
+        if constexpr (kStable) {
+            components_.swapSlots(a, b);
+        } else {
+            std::swap(components_[a], components_[b]);
+        }
+        std::swap(componentToIndex_[a], componentToIndex_[b]);
+        std::swap(added_[a], added_[b]);
+        std::swap(changed_[a], changed_[b]);
+        indexToComponent_.set(componentToIndex_[a], a);
+        indexToComponent_.set(componentToIndex_[b], b);
+    }
+
+    // Reorders the dense arrays by compare(const T&, const T&),
+    // which is not counted as a change. Returns false and keeps
+    // the order if the storage is owned by a group.
+    template <typename Compare>
+    bool sort(Compare&& compare) {
+        if (group_) {
+            return false;
+        }
+        std::pmr::vector<size_t> order(
+            components_.size(), componentToIndex_.get_allocator());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::ranges::sort(order, [this, &compare](size_t a, size_t b) {
+            return compare(
+                std::as_const(components_[a]),
+                std::as_const(components_[b]));
+        });
+        // order[i] is the position of the component that goes to i,
+        // every cycle of the permutation is applied with swaps.
+        for (size_t i = 0; i < order.size(); ++i) {
+            size_t current = i;
+            while (order[current] != i) {
+                size_t source = order[current];
+                swapDense(current, source);
+                order[current] = current;
+                current = source;
+            }
+            order[current] = current;
+        }
+        return true;
+    }
+
+    // Moves the components of the listed indices to the front
+    // in the same order, the rest follow in no particular order.
+    // Returns false and keeps the order if the storage is grouped.
+    bool sortAs(std::span<const size_t> indices) noexcept {
+        if (group_) {
+            return false;
+        }
+        size_t position = 0;
+        for (size_t index : indices) {
+            if (has(index)) {
+                swapDense(this->position(index), position++);
+            }
+        }
+        return true;
+    }
+
+    AbstractGroup* group() const noexcept {
+        return group_;
+    }
+
+    void setGroup(AbstractGroup* group) noexcept {
+        assert(!group_ || !group);
+        group_ = group;
+    }
+
+    StorageSignals& signals() noexcept {
+        return signals_;
+    }
+
+    // Dense arrays as blocks, see Serializer.
+    void save(SnapshotWriter& writer) const requires Serializable<T> {
+        writer.write<uint64_t>(components_.size());
+        writer.writeBlock(indices());
+        writer.writeBlock(std::span<const Tick>(added_));
+        writer.writeBlock(std::span<const Tick>(changed_));
+        if constexpr (CustomSerialized<T>) {
+            for (size_t position = 0; position < size(); ++position) {
+                Serializer<T>::write(writer, components_[position]);
+            }
+        } else if constexpr (kStable) {
+            for (size_t position = 0; position < size(); ++position) {
+                writer.write(components_[position]);
+            }
+        } else {
+            writer.writeBlock(std::span<const T>(components_));
+        }
+    }
+
+    // Fills the empty storage without signals, the sparse index is
+    // rebuilt in one pass. Indices rejected by valid() or repeated
+    // fail the load, the storage is left empty then.
+    template <typename Valid>
+    bool load(
+        SnapshotReader& reader, Valid&& valid
+    ) requires Serializable<T> {
+        assert(components_.empty());
+        uint64_t count = reader.read<uint64_t>();
+        if (!reader.canRead(count, sizeof(size_t) + 2 * sizeof(Tick))) {
+            return false;
+        }
+        componentToIndex_.resize(count);
+        added_.resize(count);
+        changed_.resize(count);
+        reader.readBlock(std::span<size_t>(componentToIndex_));
+        reader.readBlock(std::span<Tick>(added_));
+        reader.readBlock(std::span<Tick>(changed_));
+        if constexpr (CustomSerialized<T>) {
+            components_.reserve(count);
+            for (size_t i = 0; i < count && !reader.failed(); ++i) {
+                components_.push_back(Serializer<T>::read(reader));
+            }
+        } else if (reader.canRead(count, sizeof(T))) {
+            if constexpr (kStable) {
+                components_.reserve(count);
+                for (size_t i = 0; i < count; ++i) {
+                    components_.push_back(reader.read<T>());
+                }
+            } else {
+                components_.resize(count);
+                reader.readBlock(std::span<T>(components_));
+            }
+        }
+        for (size_t i = 0; i < count && !reader.failed(); ++i) {
+            size_t index = componentToIndex_[i];
+            if (!valid(index) || has(index)) {
+                reader.fail();
+                break;
+            }
+            indexToComponent_.set(index, i);
+        }
+        if (reader.failed()) {
+            discard();
+            return false;
+        }
+        if (group_) {
+            for (size_t index : componentToIndex_) {
+                group_->onInsert(index);
+            }
+        }
+        return true;
+    }
+
+    // Indices of the given ones that have no component, then the slots
+    // changed after since with their components.
+    void saveDelta(
+        SnapshotWriter& writer, Tick since, std::span<const size_t> touched
+    ) const requires Serializable<T> {
+        saveAbsent(writer, touched);
+        std::vector<size_t> positions;
+        for (size_t position = 0; position < changed_.size(); ++position) {
+            if (changed_[position] > since) {
+                positions.push_back(position);
+            }
+        }
+        writer.write<uint64_t>(positions.size());
+        for (size_t position : positions) {
+            writer.write(componentToIndex_[position]);
+        }
+        for (size_t position : positions) {
+            if constexpr (CustomSerialized<T>) {
+                Serializer<T>::write(writer, components_[position]);
+            } else {
+                writer.write(components_[position]);
+            }
+        }
+    }
+
+    // Drops the contents without signals.
+    void discard() noexcept {
+        if (group_) {
+            group_->onClear();
+        }
+        indexToComponent_.clear();
+        components_.clear();
+        componentToIndex_.clear();
+        added_.clear();
+        changed_.clear();
+    }
+
+private:
+    SparseIndex indexToComponent_;
+    std::conditional_t<kStable, PagedComponents<T>, std::pmr::vector<T>>
+        components_;
+    std::pmr::vector<size_t> componentToIndex_;
+    std::pmr::vector<Tick> added_;
+    std::pmr::vector<Tick> changed_;
+    Tick tick_ = 1;
+    AbstractGroup* group_ = nullptr;
+    StorageSignals signals_;
+
+    // Stores only if the tick differs, so that concurrent readers
+    // do not keep writing the same cache lines.
+    void stamp(size_t position) noexcept {
+        std::atomic_ref<Tick> changed(changed_[position]);
+        if (changed.load(std::memory_order_relaxed) != tick_) {
+            changed.store(tick_, std::memory_order_relaxed);
+        }
+    }
+
+    auto first(size_t count) noexcept {
+        if constexpr (kStable) {
+            return components_.first(count);
+        } else {
+            return std::span<T>(components_).first(count);
+        }
+    }
+
+    auto first(size_t count) const noexcept {
+        if constexpr (kStable) {
+            return components_.first(count);
+        } else {
+            return std::span<const T>(components_).first(count);
+        }
+    }
+
+    void saveAbsent(
+        SnapshotWriter& writer, std::span<const size_t> touched
+    ) const {
+        std::vector<size_t> absent;
+        for (size_t index : touched) {
+            if (!has(index)) {
+                absent.push_back(index);
+            }
+        }
+        writer.write<uint64_t>(absent.size());
+        writer.writeBlock(std::span<const size_t>(absent));
+    }
+};
+
+
+// Random access stand-in for the dense components of an empty type,
+// every element is the same instance.
+template <typename T>
+class RepeatedComponent {
+public:
+    RepeatedComponent(T& value, size_t size) noexcept
+    : value_(&value), size_(size) {}
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    T& operator[](size_t) const noexcept {
+        return *value_;
+    }
+
+private:
+    T* value_;
+    size_t size_;
+};
+
+// Storage of empty tag types: a bitset over entity indices and a packed
+// index list rebuilt on demand after removals. Insertion and removal
+// are single bit operations, clear() is a fill of the bit words.
+// Tags have neither ticks nor a dense order, so they cannot be tracked
+// by Added/Changed terms or owned by groups.
+template <typename T>
+    requires std::is_empty_v<T>
+class ComponentStorage<T> : public AbstractComponentStorage {
+public:
+    ComponentStorage() = default;
+
+    explicit ComponentStorage(std::pmr::memory_resource* resource)
+    : bits_(resource), packed_(resource) {}
+
+    ~ComponentStorage() = default;
+
+    ComponentStorage(const ComponentStorage&) = delete;
+    ComponentStorage& operator=(const ComponentStorage&) = delete;
+    ComponentStorage(ComponentStorage&&) = delete;
+    ComponentStorage& operator=(ComponentStorage&&) = delete;
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    bool has(size_t index) const noexcept {
+        return index / 64 < bits_.size()
+            && (bits_[index / 64] >> (index % 64) & 1);
+    }
+
+    T& get(size_t index) noexcept {
+        assert(has(index));
+        return value_;
+    }
+
+    const T& get(size_t index) const noexcept {
+        assert(has(index));
+        return value_;
+    }
+
+    T* find(size_t index) noexcept {
+        return has(index) ? &value_ : nullptr;
+    }
+
+    const T* find(size_t index) const noexcept {
+        return has(index) ? &value_ : nullptr;
+    }
+
+    void setTick(Tick) noexcept override {}
+
+    void insert(size_t index, T&&) noexcept {
+        if (has(index)) {
+            StorageSignals::emit(signals_.update, index);
+            return;
+        }
+        if (index / 64 >= bits_.size()) {
+            bits_.resize(index / 64 + 1);
+        }
+        bits_[index / 64] |= bit(index);
+        ++size_;
+        if (!dirty_.load(std::memory_order_relaxed)) {
+            packed_.push_back(index);
+        }
+        StorageSignals::emit(signals_.construct, index);
+    }
+
+    // Tags are single bits, there is no dense block to append.
+    template <typename Values>
+    void insertRange(std::span<const size_t> indices, Values&&) {
+        reserve(indices.size());
+        for (size_t index : indices) {
+            insert(index, T{});
+        }
+    }
+
+    void reserve(size_t count) {
+        if (!dirty_.load(std::memory_order_relaxed)) {
+            packed_.reserve(size_ + count);
+        }
+    }
+
+    void remove(size_t index) noexcept {
+        assert(has(index));
+        StorageSignals::emit(signals_.destroy, index);
+        bits_[index / 64] &= ~bit(index);
+        --size_;
+        dirty_.store(true, std::memory_order_relaxed);
+    }
+
+    void clear() noexcept {
+        clear([](size_t) {});
+    }
+
+    template <typename Func>
+    void clear(Func&& onRemove) noexcept {
+        for (size_t index : indices()) {
+            StorageSignals::emit(signals_.destroy, index);
+            onRemove(index);
+        }
+        std::ranges::fill(bits_, 0);
+        size_ = 0;
+        packed_.clear();
+        dirty_.store(false, std::memory_order_relaxed);
+    }
+
+    void removeIfHas(size_t index) noexcept override {
+        if (has(index)) {
+            remove(index);
+        }
+    }
+
+    // Ascending after a rebuild. Safe to call from concurrent readers.
+    std::span<const size_t> indices() const noexcept {
+        if (dirty_.load(std::memory_order_acquire)) {
+            rebuild();
+        }
+        return std::span<const size_t>(packed_);
+    }
+
+    RepeatedComponent<T> components() noexcept {
+        return RepeatedComponent<T>(value_, size_);
+    }
+
+    RepeatedComponent<const T> components() const noexcept {
+        return RepeatedComponent<const T>(value_, size_);
+    }
+
+    RepeatedComponent<T> components(size_t, size_t) noexcept {
+        return components();
+    }
+
+    StorageSignals& signals() noexcept {
+        return signals_;
+    }
+
+    void save(SnapshotWriter& writer) const {
+        writer.write<uint64_t>(size_);
+        writer.writeBlock(indices());
+    }
+
+    template <typename Valid>
+    bool load(SnapshotReader& reader, Valid&& valid) {
+        assert(size_ == 0);
+        uint64_t count = reader.read<uint64_t>();
+        if (!reader.canRead(count, sizeof(size_t))) {
+            return false;
+        }
+        packed_.resize(count);
+        reader.readBlock(std::span<size_t>(packed_));
+        for (size_t i = 0; i < count && !reader.failed(); ++i) {
+            size_t index = packed_[i];
+            if (!valid(index) || has(index)) {
+                reader.fail();
+                break;
+            }
+            if (index / 64 >= bits_.size()) {
+                bits_.resize(index / 64 + 1);
+            }
+            bits_[index / 64] |= bit(index);
+            ++size_;
+        }
+        if (reader.failed()) {
+            discard();
+            return false;
+        }
+        return true;
+    }
+
+    // Tags have no ticks, so both lists are taken from the given indices.
+    void saveDelta(
+        SnapshotWriter& writer, Tick, std::span<const size_t> touched
+    ) const {
+        std::vector<size_t> absent;
+        std::vector<size_t> present;
+        for (size_t index : touched) {
+            (has(index) ? present : absent).push_back(index);
+        }
+        writer.write<uint64_t>(absent.size());
+        writer.writeBlock(std::span<const size_t>(absent));
+        writer.write<uint64_t>(present.size());
+        writer.writeBlock(std::span<const size_t>(present));
+    }
+
+    void discard() noexcept {
+        std::ranges::fill(bits_, 0);
+        size_ = 0;
+        packed_.clear();
+        dirty_.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    std::pmr::vector<uint64_t> bits_;
+    size_t size_ = 0;
+    mutable std::pmr::vector<size_t> packed_;
+    mutable std::atomic<bool> dirty_ = false;
+    mutable std::mutex rebuildMutex_;
+    StorageSignals signals_;
+    [[no_unique_address]] T value_;
+
+    static uint64_t bit(size_t index) noexcept {
+        return uint64_t{1} << (index % 64);
+    }
+
+    void rebuild() const {
+        std::lock_guard lock(rebuildMutex_);
+        if (!dirty_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        packed_.clear();
+        packed_.reserve(size_);
+        for (size_t word = 0; word < bits_.size(); ++word) {
+            uint64_t bits = bits_[word];
+            while (bits) {
+                packed_.push_back(word * 64 + std::countr_zero(bits));
+                bits &= bits - 1;
+            }
+        }
+        dirty_.store(false, std::memory_order_release);
+    }
+};
+
+
+// Keeps the entities having all the components at the front of every
+// owned storage in the same order, so they can be iterated in lockstep.
+template <typename... Components>
+class OwningGroup : public AbstractGroup {
+    static_assert(
+        !(std::is_empty_v<Components> || ...),
+        "Empty components have no dense order to pack");
+
+public:
+    explicit OwningGroup(ComponentStorage<Components>*... storages) noexcept
+    : storages_(storages...) {
+        (storages->setGroup(this), ...);
+        auto& first = *std::get<0>(storages_);
+        for (size_t position = 0; position < first.size(); ++position) {
+            onInsert(first.indices()[position]);
+        }
+    }
+
+    ~OwningGroup() {
+        std::apply(
+            [](auto*... storages) { (storages->setGroup(nullptr), ...); },
+            storages_);
+    }
+
+    OwningGroup(const OwningGroup&) = delete;
+    OwningGroup& operator=(const OwningGroup&) = delete;
+
+    size_t size() const noexcept override {
+        return size_;
+    }
+
+    size_t ownedCount() const noexcept override {
+        return sizeof...(Components);
+    }
+
+    void onInsert(size_t index) noexcept override {
+        bool complete = std::apply(
+            [index](auto*... storages) {
+                return (storages->has(index) && ...); },
+            storages_);
+        if (!complete || std::get<0>(storages_)->position(index) < size_) {
+            return;
+        }
+        moveTo(index, size_);
+        ++size_;
+    }
+
+    void onRemove(size_t index) noexcept override {
+        auto& first = *std::get<0>(storages_);
+        if (!first.has(index) || first.position(index) >= size_) {
+            return;
+        }
+        --size_;
+        moveTo(index, size_);
+    }
+
+    void onClear() noexcept override {
+        size_ = 0;
+    }
+
+private:
+    std::tuple<ComponentStorage<Components>*...> storages_;
+    size_t size_ = 0;
+
+    void moveTo(size_t index, size_t position) noexcept {
+        std::apply(
+            [index, position](auto*... storages) {
+                (storages->swapDense(storages->position(index), position),
+                    ...);
+            },
+            storages_);
+    }
+};
+
+
+// Access to the storages behind a single view term.
+template <typename Component>
+class StorageTerm {
+public:
+    using ComponentList = TypeList<Component>;
+    static constexpr bool kDriver = true;
+
+    explicit StorageTerm(ComponentStorage<Component>* storage)
+    : storage_(storage) {}
+
+    std::span<const size_t> indices() const noexcept {
+        return storage_->indices();
+    }
+
+    bool check(size_t index) const noexcept {
+        return storage_->has(index);
+    }
+
+    bool fetch(size_t index) noexcept {
+        component_ = storage_->find(index);
+        return component_ != nullptr;
+    }
+
+    std::tuple<Component&> args() const noexcept {
+        return {*component_};
+    }
+
+private:
+    ComponentStorage<Component>* storage_;
+    Component* component_ = nullptr;
+};
+
+template <typename... Components>
+class StorageTerm<Without<Components...>> {
+public:
+    using ComponentList = TypeList<Components...>;
+    static constexpr bool kDriver = false;
+
+    explicit StorageTerm(ComponentStorage<Components>*... storages)
+    : storages_(storages...) {}
+
+    bool check(size_t index) const noexcept {
+        return std::apply(
+            [index](const auto*... storages) {
+                return !(storages->has(index) || ...); },
+            storages_);
+    }
+
+    bool fetch(size_t index) noexcept {
+        return check(index);
+    }
+
+    std::tuple<> args() const noexcept {
+        return {};
+    }
+
+private:
+    std::tuple<ComponentStorage<Components>*...> storages_;
+};
+
+// A const component is looked up through the const storage,
+// so it is not counted as a change.
+template <typename Component>
+class StorageTerm<Optional<Component>> {
+public:
+    using ComponentList = TypeList<Component>;
+    static constexpr bool kDriver = false;
+
+    explicit StorageTerm(
+        ComponentStorage<std::remove_const_t<Component>>* storage)
+    : storage_(storage) {}
+
+    bool check(size_t) const noexcept {
+        return true;
+    }
+
+    bool fetch(size_t index) noexcept {
+        component_ = storage_->find(index);
+        return true;
+    }
+
+    std::tuple<Component*> args() const noexcept {
+        return {component_};
+    }
+
+private:
+    std::conditional_t<
+        std::is_const_v<Component>,
+        const ComponentStorage<std::remove_const_t<Component>>,
+        ComponentStorage<Component>>* storage_;
+    Component* component_ = nullptr;
+};
+
+
+template <typename Component>
+class StorageTerm<const Component> {
+public:
+    using ComponentList = TypeList<Component>;
+    static constexpr bool kDriver = true;
+
+    explicit StorageTerm(const ComponentStorage<Component>* storage)
+    : storage_(storage) {}
+
+    std::span<const size_t> indices() const noexcept {
+        return storage_->indices();
+    }
+
+    bool check(size_t index) const noexcept {
+        return storage_->has(index);
+    }
+
+    bool fetch(size_t index) noexcept {
+        component_ = storage_->find(index);
+        return component_ != nullptr;
+    }
+
+    std::tuple<const Component&> args() const noexcept {
+        return {*component_};
+    }
+
+private:
+    const ComponentStorage<Component>* storage_;
+    const Component* component_ = nullptr;
+};
+
+// Added (kAdded) and Changed terms comparing the slot ticks with since.
+template <typename Component, bool kAdded>
+class TrackedTerm {
+    static_assert(
+        !std::is_empty_v<Component>, "Empty components are not tracked");
+
+public:
+    using ComponentList = TypeList<Component>;
+    static constexpr bool kDriver = true;
+
+    TrackedTerm(const ComponentStorage<Component>* storage, Tick since)
+    : storage_(storage), since_(since) {}
+
+    std::span<const size_t> indices() const noexcept {
+        return storage_->indices();
+    }
+
+    bool check(size_t index) const noexcept {
+        return storage_->has(index) && tick(index) > since_;
+    }
+
+    bool fetch(size_t index) noexcept {
+        if (!check(index)) {
+            return false;
+        }
+        component_ = &storage_->get(index);
+        return true;
+    }
+
+    std::tuple<const Component&> args() const noexcept {
+        return {*component_};
+    }
+
+private:
+    const ComponentStorage<Component>* storage_;
+    Tick since_;
+    const Component* component_ = nullptr;
+
+    Tick tick(size_t index) const noexcept {
+        return kAdded
+            ? storage_->addedTick(index)
+            : storage_->changedTick(index);
+    }
+};
+
+template <typename Component>
+class StorageTerm<Added<Component>> : public TrackedTerm<Component, true> {
+public:
+    using TrackedTerm<Component, true>::TrackedTerm;
+};
+
+template <typename Component>
+class StorageTerm<Changed<Component>>
+    : public TrackedTerm<Component, false> {
+public:
+    using TrackedTerm<Component, false>::TrackedTerm;
+};
+
+
+template<typename... Terms>
+class ComponentFilter {
 public:
-    virtual ~AbstractComponentStorage() = default;
-    virtual void removeIfHas(size_t index) noexcept = 0;
+    static_assert(
+        (StorageTerm<Terms>::kDriver || ...),
+        "At least one required component expected");
+
+    explicit ComponentFilter(StorageTerm<Terms>... terms) : terms_(terms...) {}
+
+    ComponentFilter(const ComponentFilter&) = default;
+    ComponentFilter& operator=(const ComponentFilter&) = default;
+    ComponentFilter(ComponentFilter&&) = default;
+    ComponentFilter& operator=(ComponentFilter&&) = default;
+
+    // Dense indices of the smallest required storage.
+    std::span<const size_t> driver() const noexcept {
+        std::optional<std::span<const size_t>> result;
+        std::apply(
+            [&result](const auto&... terms) {
+                (consider(result, terms), ...); },
+            terms_);
+        return *result;
+    }
+
+    bool check(size_t index) const noexcept {
+        return std::apply(
+            [index](const auto&... terms) {
+                return (terms.check(index) && ...); },
+            terms_);
+    }
+
+    bool fetch(size_t index) noexcept {
+        return std::apply(
+            [index](auto&... terms) {
+                return (terms.fetch(index) && ...); },
+            terms_);
+    }
+
+    auto args() const noexcept {
+        return std::apply(
+            [](const auto&... terms) {
+                return std::tuple_cat(terms.args()...); },
+            terms_);
+    }
+
+private:
+    std::tuple<StorageTerm<Terms>...> terms_;
+
+    template <typename Term>
+    static void consider(
+        std::optional<std::span<const size_t>>& result, const Term& term
+    ) noexcept {
+        if constexpr (Term::kDriver) {
+            if (!result || term.indices().size() < result->size()) {
+                result = term.indices();
+            }
+        }
+    }
 };
 
-template <typename T>
-class ComponentStorage : public AbstractComponentStorage {
+
+// Required and excluded component type ids as bit words.
+class SignatureMask {
 public:
-    ComponentStorage() = default;
-    ~ComponentStorage() = default;
+    void require(size_t id) {
+        set(required_, id);
+    }
 
-    ComponentStorage(const ComponentStorage&) = delete;
-    ComponentStorage& operator=(const ComponentStorage&) = delete;
-    ComponentStorage(ComponentStorage&&) = default;
-    ComponentStorage& operator=(ComponentStorage&&) = default;
+    void exclude(size_t id) {
+        set(excluded_, id);
+    }
 
-    size_t size() const noexcept {
-        return components_.size();
+    const std::vector<uint64_t>& required() const noexcept {
+        return required_;
     }
 
-    bool has(size_t index) const noexcept {
-        return index < indexToComponent_.size()
-            && indexToComponent_[index] >= 0;
+    const std::vector<uint64_t>& excluded() const noexcept {
+        return excluded_;
     }
 
-    T& get(size_t index) noexcept {
-        assert(has(index));
-        return components_[indexToComponent_[index]];
+private:
+    std::vector<uint64_t> required_;
+    std::vector<uint64_t> excluded_;
+
+    static void set(std::vector<uint64_t>& words, size_t id) {
+        if (id / 64 >= words.size()) {
+            words.resize(id / 64 + 1);
+        }
+        words[id / 64] |= uint64_t{1} << (id % 64);
     }
+};
 
-    void insert(size_t index, T&& value) noexcept {
-        if (has(index)) {
-            components_[indexToComponent_[index]] = std::forward<T>(value);
-            return;
+
+// Bitset of the component type ids of every entity index.
+// Rows are stored contiguously and widened when a new type id
+// does not fit.
+class SignatureTable {
+public:
+    SignatureTable() = default;
+
+    explicit SignatureTable(std::pmr::memory_resource* resource)
+    : bits_(resource) {}
+
+    bool test(size_t index, size_t id) const noexcept {
+        size_t word = id / kWordBits;
+        return index < rowCount() && word < words_
+            && (bits_[index * words_ + word] >> (id % kWordBits) & 1);
+    }
+
+    void set(size_t index, size_t id) {
+        if (id / kWordBits >= words_) {
+            widen(id / kWordBits + 1);
         }
-        if (index >= indexToComponent_.size()) {
-            indexToComponent_.resize(index + 1, EMPTY);
+        if (index >= rowCount()) {
+            bits_.resize((index + 1) * words_);
         }
-        indexToComponent_[index] = components_.size();
-        components_.push_back(std::forward<T>(value));
-        componentToIndex_.push_back(index);
+        bits_[index * words_ + id / kWordBits] |= bit(id);
     }
 
-    void remove(size_t index) noexcept {
-        assert(has(index));
-        size_t componentIndex = indexToComponent_[index];
-        if (componentIndex < components_.size() - 1) {
-            indexToComponent_[componentToIndex_.back()] = componentIndex;
-            components_[componentIndex] = std::move(components_.back());
-            componentToIndex_[componentIndex] = componentToIndex_.back();
+    void reset(size_t index, size_t id) noexcept {
+        if (test(index, id)) {
+            bits_[index * words_ + id / kWordBits] &= ~bit(id);
+        }
+    }
+
+    void resetRow(size_t index) noexcept {
+        if (index < rowCount()) {
+            std::fill_n(bits_.begin() + index * words_, words_, 0);
         }
-        indexToComponent_[index] = EMPTY;
-        components_.pop_back();
-        componentToIndex_.pop_back();
     }
 
     void clear() noexcept {
-        indexToComponent_.clear();
-        components_.clear();
-        componentToIndex_.clear();
+        bits_.clear();
     }
 
-    void removeIfHas(size_t index) noexcept override {
-        if (has(index)) {
-            remove(index);
+    // One past the highest index that ever had a component.
+    size_t size() const noexcept {
+        return rowCount();
+    }
+
+    // Calls func(id) for every type id of the index.
+    template <typename Func>
+    void forEach(size_t index, Func&& func) const {
+        if (index >= rowCount()) {
+            return;
+        }
+        for (size_t word = 0; word < words_; ++word) {
+            uint64_t bits = bits_[index * words_ + word];
+            while (bits) {
+                func(word * kWordBits + std::countr_zero(bits));
+                bits &= bits - 1;
+            }
         }
     }
 
-    std::span<const size_t> indices() const noexcept {
-        return std::span<const size_t>(componentToIndex_);
+    bool matches(size_t index, const SignatureMask& mask) const noexcept {
+        const auto& required = mask.required();
+        const auto& excluded = mask.excluded();
+        for (size_t word = 0; word < required.size(); ++word) {
+            if ((row(index, word) & required[word]) != required[word]) {
+                return false;
+            }
+        }
+        for (size_t word = 0; word < excluded.size(); ++word) {
+            if (row(index, word) & excluded[word]) {
+                return false;
+            }
+        }
+        return true;
     }
 
 private:
-    static constexpr int32_t EMPTY = -1;
+    static constexpr size_t kWordBits = 64;
+
+    std::pmr::vector<uint64_t> bits_;
+    size_t words_ = 1;
 
-    std::vector<int32_t> indexToComponent_;
-    std::vector<T> components_;
-    std::vector<size_t> componentToIndex_;
+    static uint64_t bit(size_t id) noexcept {
+        return uint64_t{1} << (id % kWordBits);
+    }
+
+    size_t rowCount() const noexcept {
+        return bits_.size() / words_;
+    }
+
+    uint64_t row(size_t index, size_t word) const noexcept {
+        return index < rowCount() && word < words_
+            ? bits_[index * words_ + word]
+            : 0;
+    }
+
+    void widen(size_t words) {
+        std::pmr::vector<uint64_t> bits(
+            rowCount() * words, bits_.get_allocator());
+        for (size_t index = 0; index < rowCount(); ++index) {
+            std::copy_n(
+                bits_.begin() + index * words_, words_,
+                bits.begin() + index * words);
+        }
+        bits_ = std::move(bits);
+        words_ = words;
+    }
 };
 
 
-template<typename... Storages>
-class ComponentFilter {
+// Packed indices matching a signature mask, kept up to date
+// by the component manager on every structural change.
+class CachedQuery {
 public:
-    ComponentFilter(const Storages*... storages) : storages_(storages...) {
-        assert(true);
+    CachedQuery(SignatureMask mask, std::pmr::memory_resource* resource)
+    : mask_(std::move(mask)), positions_(resource), indices_(resource) {}
+
+    const SignatureMask& mask() const noexcept {
+        return mask_;
     }
 
-    ComponentFilter(const ComponentFilter&) = default;
-    ComponentFilter& operator=(const ComponentFilter&) = default;
-    ComponentFilter(ComponentFilter&&) = default;
-    ComponentFilter& operator=(ComponentFilter&&) = default;
+    std::span<const size_t> indices() const noexcept {
+        return std::span<const size_t>(indices_);
+    }
 
-    bool check(size_t index) const noexcept {
-        return (std::get<const Storages*>(storages_)->has(index) && ...);
+    void update(size_t index, bool matches) {
+        int32_t position = positions_.get(index);
+        if (matches && position < 0) {
+            positions_.set(index, indices_.size());
+            indices_.push_back(index);
+        } else if (!matches && position >= 0) {
+            erase(index, position);
+        }
+    }
+
+    void erase(size_t index) noexcept {
+        int32_t position = positions_.get(index);
+        if (position >= 0) {
+            erase(index, position);
+        }
+    }
+
+    void rebuild(const SignatureTable& signatures) {
+        positions_.clear();
+        indices_.clear();
+        for (size_t index = 0; index < signatures.size(); ++index) {
+            update(index, signatures.matches(index, mask_));
+        }
     }
 
 private:
-    std::tuple<const Storages*...> storages_;
+    SignatureMask mask_;
+    SparseIndex positions_;
+    std::pmr::vector<size_t> indices_;
+
+    void erase(size_t index, size_t position) noexcept {
+        if (position < indices_.size() - 1) {
+            positions_.set(indices_.back(), position);
+            indices_[position] = indices_.back();
+        }
+        positions_.reset(index);
+        indices_.pop_back();
+    }
+};
+
+
+// Records of a storage in a delta read ahead of applying them:
+// the indices losing the component, then the ones getting it
+// with the components unless the type is empty.
+template <typename T>
+struct StorageDelta {
+    std::vector<size_t> removed;
+    std::vector<size_t> present;
+    std::vector<T> components;
 };
 
+template <typename... Components>
+using ComponentDelta = std::tuple<StorageDelta<Components>...>;
 
+
+template <typename Term>
+struct IsWithout : std::false_type {};
+
+template <typename Term>
+struct IsTracked : std::false_type {};
+
+template <typename Component>
+struct IsTracked<Added<Component>> : std::true_type {};
+
+template <typename Component>
+struct IsTracked<Changed<Component>> : std::true_type {};
+
+template <typename... Components>
+struct IsWithout<Without<Components...>> : std::true_type {};
+
+
+// Storage contents, the storage and group tables, the signatures and
+// the cached queries are allocated from the memory resource given
+// on construction. The resource must outlive the manager.
 class ComponentManager {
 public:
     ComponentManager() = default;
+
+    explicit ComponentManager(std::pmr::memory_resource* resource)
+    : storages_(resource), groups_(resource), signatures_(resource),
+        touched_(resource), queries_(resource), watchers_(resource) {}
+
     ~ComponentManager() = default;
 
     ComponentManager(const ComponentManager&) = delete;
     ComponentManager& operator=(const ComponentManager&) = delete;
     ComponentManager(ComponentManager&&) noexcept = default;
-    ComponentManager& operator=(ComponentManager&&) noexcept = default;
+
+    // Groups detach from the storages they own when destroyed,
+    // so the old ones go before their storages.
+    ComponentManager& operator=(ComponentManager&& other) noexcept {
+        if (this != &other) {
+            clear();
+            storages_ = std::move(other.storages_);
+            groups_ = std::move(other.groups_);
+            signatures_ = std::move(other.signatures_);
+            touched_ = std::move(other.touched_);
+            queries_ = std::move(other.queries_);
+            watchers_ = std::move(other.watchers_);
+            tick_ = other.tick_;
+        }
+        return *this;
+    }
 
     template <typename Component>
     bool has(size_t index) const noexcept {
-        auto it = storages_.find(key<Component>());
-        return it != storages_.end()
-            && as<Component>(*it->second).has(index);
+        return signatures_.test(index, typeId<Component>());
     }
 
     template <typename Component>
     size_t count() const noexcept {
-        auto it = storages_.find(key<Component>());
-        return it != storages_.end()
-            ? as<Component>(*it->second).size()
-            : 0;
+        auto storage = findStorage<Component>();
+        return storage ? storage->size() : 0;
     }
 
+    // A const component is read without counting it as a change.
     template <typename Component>
     Component& get(size_t index) noexcept {
         assert(has<Component>(index));
-        return getStorage<Component>().get(index);
+        if constexpr (std::is_const_v<Component>) {
+            return std::as_const(getStorage<Component>()).get(index);
+        } else {
+            return getStorage<Component>().get(index);
+        }
+    }
+
+    template <typename Component>
+    const Component& get(size_t index) const noexcept {
+        assert(has<Component>(index));
+        return findStorage<Component>()->get(index);
     }
 
+    // The signature is set first, so that listeners see the component.
     template <typename Component>
     void insert(size_t index, Component&& value) noexcept {
-        ensureStorage<Component>().insert(
-            index, std::forward<Component>(value));
+        auto& storage = ensureStorage<Component>();
+        bool added = !has<Component>(index);
+        if (added) {
+            touch(index);
+        }
+        signatures_.set(index, typeId<Component>());
+        storage.insert(index, std::forward<Component>(value));
+        if (added) {
+            notify(index, typeId<Component>());
+        }
+    }
+
+    // Inserts values[i] into indices[i], values holds one element
+    // per index. Signatures are set for the whole batch before
+    // the storage appends it, queries are notified after.
+    template <typename Component, typename Values>
+    void insertRange(std::span<const size_t> indices, Values&& values) {
+        auto& storage = ensureStorage<Component>();
+        const size_t id = typeId<Component>();
+        std::vector<size_t> added;
+        for (size_t index : indices) {
+            if (!signatures_.test(index, id)) {
+                touch(index);
+                signatures_.set(index, id);
+                added.push_back(index);
+            }
+        }
+        storage.insertRange(indices, std::forward<Values>(values));
+        for (size_t index : added) {
+            notify(index, id);
+        }
+    }
+
+    template <typename Component>
+    StorageSignals& signals() noexcept {
+        return ensureStorage<Component>().signals();
+    }
+
+    template <typename Component>
+    void reserve(size_t count) noexcept {
+        ensureStorage<Component>().reserve(count);
     }
 
     template <typename Component>
     void remove(size_t index) noexcept {
         assert(has<Component>(index));
         getStorage<Component>().remove(index);
+        signatures_.reset(index, typeId<Component>());
+        touch(index);
+        notify(index, typeId<Component>());
     }
 
     template <typename Component>
     void removeAll() noexcept {
-        ensureStorage<Component>().clear();
+        ensureStorage<Component>().clear([this](size_t index) {
+            signatures_.reset(index, typeId<Component>());
+            touch(index);
+            notify(index, typeId<Component>());
+        });
+    }
+
+    // Creates the storage up front, so that systems running
+    // concurrently never modify the storage table.
+    template <typename Component>
+    void registerComponent() noexcept {
+        ensureStorage<Component>();
     }
 
+    // Visits only the storages the index belongs to and the queries
+    // watching them, a matching query requires one of them.
     void clearIndex(size_t index) noexcept {
-        for (auto& it : storages_) {
-            it.second->removeIfHas(index);
-        }
+        signatures_.forEach(index, [this, index](size_t id) {
+            storages_[id]->removeIfHas(index);
+            if (id < watchers_.size()) {
+                for (CachedQuery* query : watchers_[id]) {
+                    query->erase(index);
+                }
+            }
+        });
+        signatures_.resetRow(index);
+        touch(index);
     }
 
     void clear() noexcept {
+        queries_.clear();
+        watchers_.clear();
+        groups_.clear();
         storages_.clear();
+        signatures_.clear();
+        touched_.clear();
+    }
+
+    // Owning group of the storages, each() over exactly these
+    // components then scans the packed members in lockstep.
+    // A storage can be owned by a single group, returns false if one
+    // of them is owned by another group already.
+    template <typename... Components>
+    bool group() {
+        static_assert(sizeof...(Components) > 1);
+        if (findGroup<Components...>()) {
+            return true;
+        }
+        if ((ownedByAny<Components>() || ...)) {
+            return false;
+        }
+        groups_.push_back(std::make_unique<OwningGroup<Components...>>(
+            &ensureStorage<Components>()...));
+        return true;
+    }
+
+    // Sorting fails on a grouped storage, see ComponentStorage::sort().
+    template <typename Component, typename Compare>
+    bool sort(Compare&& compare) {
+        static_assert(
+            !std::is_empty_v<Component>, "Empty components are not ordered");
+        return ensureStorage<Component>().sort(
+            std::forward<Compare>(compare));
+    }
+
+    template <typename Component, typename Other>
+    bool sortAs() {
+        static_assert(
+            !std::is_empty_v<Component>, "Empty components are not ordered");
+        static_assert(!std::is_same_v<Component, Other>);
+        auto& storage = ensureStorage<Component>();
+        return storage.sortAs(ensureStorage<Other>().indices());
+    }
+
+    // Moves the components of the listed indices to the front in order.
+    template <typename Component>
+    bool sortAs(std::span<const size_t> indices) {
+        return ensureStorage<Component>().sortAs(indices);
+    }
+
+    // Indices matching the terms, kept by a persistent query registered
+    // on the first call. Every later structural change of the listed
+    // components updates it, and each() over the same terms scans it.
+    template <typename... Terms>
+    std::span<const size_t> query() {
+        static_assert(
+            !(IsTracked<Terms>::value || ...),
+            "Change tracking terms are not cached");
+        static_assert(
+            (StorageTerm<Terms>::kDriver || ...),
+            "At least one required component expected");
+        size_t id = queryId<Terms...>();
+        if (id >= queries_.size()) {
+            queries_.resize(id + 1);
+        }
+        if (!queries_[id]) {
+            SignatureMask mask = makeMask<Terms...>();
+            queries_[id] = std::make_unique<CachedQuery>(
+                mask, queries_.get_allocator().resource());
+            queries_[id]->rebuild(signatures_);
+            watch(queries_[id].get(), mask.required());
+            watch(queries_[id].get(), mask.excluded());
+        }
+        return queries_[id]->indices();
+    }
+
+    Tick tick() const noexcept {
+        return tick_;
+    }
+
+    // Starts the next tick and returns the one that ended.
+    Tick advanceTick() noexcept {
+        ++tick_;
+        for (auto& storage : storages_) {
+            if (storage) {
+                storage->setTick(tick_);
+            }
+        }
+        return tick_ - 1;
+    }
+
+    // Writes the tick and the listed storages in order, each one
+    // prefixed by the component size as a light format check.
+    template <typename... Components>
+    void save(SnapshotWriter& writer) const {
+        writer.write(tick_);
+        (saveStorage<Components>(writer), ...);
+    }
+
+    // Loads storages saved with the same component list while no index
+    // has components. Indices rejected by valid() fail the load,
+    // all the listed storages are left empty then.
+    template <typename... Components, typename Valid>
+    bool load(SnapshotReader& reader, Valid&& valid) {
+        Tick tick = reader.read<Tick>();
+        if (reader.failed()) {
+            return false;
+        }
+        tick_ = tick;
+        for (auto& storage : storages_) {
+            if (storage) {
+                storage->setTick(tick_);
+            }
+        }
+        touched_.clear();
+        bool loaded = (loadStorage<Components>(reader, valid) && ...);
+        if (!loaded) {
+            (ensureStorage<Components>().discard(), ...);
+            signatures_.clear();
+        }
+        for (auto& query : queries_) {
+            if (query) {
+                query->rebuild(signatures_);
+            }
+        }
+        return loaded;
+    }
+
+    // Writes the listed storages in order: the indices accepted by
+    // live() whose component set changed after since and that lack
+    // the component, then the components inserted or changed after since.
+    template <typename... Components, typename Live>
+    void saveDelta(SnapshotWriter& writer, Tick since, Live&& live) const {
+        std::vector<size_t> touched;
+        for (size_t index = 0; index < touched_.size(); ++index) {
+            if (touched_[index] > since && live(index)) {
+                touched.push_back(index);
+            }
+        }
+        (saveStorageDelta<Components>(writer, since, touched), ...);
+    }
+
+    // Reads storage deltas without changing anything. Stops at
+    // the first malformed record or index rejected by valid().
+    template <typename... Components, typename Valid>
+    bool readDelta(
+        SnapshotReader& reader, Valid&& valid,
+        ComponentDelta<Components...>& delta
+    ) const {
+        return std::apply(
+            [&reader, &valid](StorageDelta<Components>&... storages) {
+                return (readStorageDelta(reader, valid, storages) && ...);
+            },
+            delta);
+    }
+
+    // Applies storage deltas read by readDelta() with insert() and
+    // remove(), so listeners are notified and the changes are stamped
+    // with the current tick.
+    template <typename... Components>
+    void applyDelta(ComponentDelta<Components...>&& delta) {
+        std::apply(
+            [this](StorageDelta<Components>&... storages) {
+                (applyStorageDelta(std::move(storages)), ...);
+            },
+            delta);
+    }
+
+    // Iterates the smallest of the required storages
+    // and filters by the rest of the terms.
+    // Added and Changed terms match ticks after since.
+    template<typename... Terms>
+    auto view(Tick since = 0) noexcept {
+        if constexpr (isSingleStorage<Terms...>()) {
+            return ensureStorage<Terms...>().indices();
+        } else {
+            ComponentFilter<Terms...> filter(makeTerm<Terms>(since)...);
+            return filter.driver()
+                | std::ranges::views::filter(
+                    [this, filter, mask=makeMask<Terms...>()](size_t index) {
+                        return signatures_.matches(index, mask)
+                            && filter.check(index);
+                    });
+        }
     }
 
-    template<typename Master, typename... Pos>
-    auto view() noexcept {
-        return ensureStorage<Master>().indices()
-            | std::ranges::views::filter(
-                [filter=ComponentFilter(&ensureStorage<Pos>()...)](
-                    size_t index
-                ) {
-                    return filter.check(index);
+    // Calls func(index, args...) for every index matching the terms,
+    // where a component term yields a reference, Optional yields
+    // a pointer and Without yields nothing. The storages are resolved
+    // once, so func must not insert or remove the iterated components.
+    template<typename... Terms, typename Func>
+    void each(Func&& func) {
+        each<Terms...>(0, std::forward<Func>(func));
+    }
+
+    template<typename... Terms, typename Func>
+    void each(Tick since, Func&& func) {
+        if constexpr (isSingleStorage<Terms...>()) {
+            auto& storage = ensureStorage<Terms...>();
+            auto indices = storage.indices();
+            auto components = storage.components();
+            for (size_t i = 0; i < indices.size(); ++i) {
+                func(indices[i], components[i]);
+            }
+        } else {
+            if constexpr (isGroupable<Terms...>()) {
+                if (const AbstractGroup* group = findGroup<Terms...>()) {
+                    eachInGroup<Terms...>(group->size(), func);
+                    return;
+                }
+            }
+            ComponentFilter<Terms...> filter(makeTerm<Terms>(since)...);
+            if constexpr (!(IsTracked<Terms>::value || ...)) {
+                if (const CachedQuery* query = findQuery<Terms...>()) {
+                    for (size_t index : query->indices()) {
+                        filter.fetch(index);
+                        std::apply(
+                            func,
+                            std::tuple_cat(
+                                std::tuple<size_t>(index), filter.args()));
+                    }
+                    return;
+                }
+            }
+            SignatureMask mask = makeMask<Terms...>();
+            for (size_t index : filter.driver()) {
+                if (signatures_.matches(index, mask) && filter.fetch(index)) {
+                    std::apply(
+                        func,
+                        std::tuple_cat(
+                            std::tuple<size_t>(index), filter.args()));
+                }
+            }
+        }
+    }
+
+    // Runs each() over chunks of the driver storage on the pool.
+    // func is called concurrently for distinct indices.
+    template<typename... Terms, typename Func>
+    void parallelEach(ThreadPool& pool, size_t chunkSize, Func&& func) {
+        if constexpr (isSingleStorage<Terms...>()) {
+            // Every chunk stamps its own components.
+            auto& storage = ensureStorage<Terms...>();
+            auto indices = storage.indices();
+            pool.parallelFor(
+                indices.size(), chunkSize,
+                [&](size_t begin, size_t end) noexcept {
+                    auto components = storage.components(begin, end);
+                    for (size_t i = begin; i < end; ++i) {
+                        func(indices[i], components[i]);
+                    }
+                });
+        } else {
+            ComponentFilter<Terms...> filter(makeTerm<Terms>(0)...);
+            SignatureMask mask = makeMask<Terms...>();
+            auto driver = filter.driver();
+            pool.parallelFor(
+                driver.size(), chunkSize,
+                [&](size_t begin, size_t end) noexcept {
+                    ComponentFilter<Terms...> local = filter;
+                    for (size_t i = begin; i < end; ++i) {
+                        if (signatures_.matches(driver[i], mask)
+                            && local.fetch(driver[i])
+                        ) {
+                            std::apply(
+                                func,
+                                std::tuple_cat(
+                                    std::tuple<size_t>(driver[i]),
+                                    local.args()));
+                        }
+                    }
                 });
+        }
     }
 
 private:
-    std::unordered_map<
-        std::type_index,
-        std::unique_ptr<AbstractComponentStorage>
-    > storages_;
+    template <typename Component>
+    using StorageOf = ComponentStorage<std::remove_cvref_t<Component>>;
+
+    std::pmr::vector<std::unique_ptr<AbstractComponentStorage>> storages_;
+    std::pmr::vector<std::unique_ptr<AbstractGroup>> groups_;
+    SignatureTable signatures_;
+    // Tick of the last component set change of every index.
+    std::pmr::vector<Tick> touched_;
+    // Cached queries by queryId().
+    std::pmr::vector<std::unique_ptr<CachedQuery>> queries_;
+    // Queries to update by component type id.
+    std::pmr::vector<std::pmr::vector<CachedQuery*>> watchers_;
+    Tick tick_ = 1;
+
+    void notify(size_t index, size_t id) {
+        if (id < watchers_.size()) {
+            for (CachedQuery* query : watchers_[id]) {
+                query->update(index, signatures_.matches(index, query->mask()));
+            }
+        }
+    }
+
+    void watch(CachedQuery* query, const std::vector<uint64_t>& words) {
+        for (size_t word = 0; word < words.size(); ++word) {
+            uint64_t bits = words[word];
+            while (bits) {
+                size_t id = word * 64 + std::countr_zero(bits);
+                if (id >= watchers_.size()) {
+                    watchers_.resize(id + 1);
+                }
+                watchers_[id].push_back(query);
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    template <typename... Terms>
+    const CachedQuery* findQuery() const noexcept {
+        size_t id = queryId<Terms...>();
+        return id < queries_.size() ? queries_[id].get() : nullptr;
+    }
+
+    void touch(size_t index) {
+        if (index >= touched_.size()) {
+            touched_.resize(index + 1);
+        }
+        touched_[index] = tick_;
+    }
+
+    template <typename Component>
+    void saveStorageDelta(
+        SnapshotWriter& writer, Tick since, std::span<const size_t> touched
+    ) const {
+        writer.write<uint64_t>(sizeof(Component));
+        if (auto storage = findStorage<Component>()) {
+            storage->saveDelta(writer, since, touched);
+        } else {
+            StorageOf<Component>().saveDelta(writer, since, touched);
+        }
+    }
+
+    template <typename Component, typename Valid>
+    static bool readStorageDelta(
+        SnapshotReader& reader, Valid& valid, StorageDelta<Component>& delta
+    ) {
+        if (reader.read<uint64_t>() != sizeof(Component)
+            || !readIndices(reader, valid, delta.removed)
+            || !readIndices(reader, valid, delta.present)
+        ) {
+            reader.fail();
+            return false;
+        }
+        if constexpr (std::is_empty_v<Component>) {
+            return true;
+        } else if constexpr (CustomSerialized<Component>) {
+            delta.components.reserve(delta.present.size());
+            for (size_t i = 0; i < delta.present.size(); ++i) {
+                delta.components.push_back(Serializer<Component>::read(reader));
+                if (reader.failed()) {
+                    return false;
+                }
+            }
+        } else {
+            if (!reader.canRead(delta.present.size(), sizeof(Component))) {
+                return false;
+            }
+            delta.components.resize(delta.present.size());
+            reader.readBlock(std::span<Component>(delta.components));
+        }
+        return !reader.failed();
+    }
+
+    template <typename Component>
+    void applyStorageDelta(StorageDelta<Component>&& delta) {
+        for (size_t index : delta.removed) {
+            if (has<Component>(index)) {
+                remove<Component>(index);
+            }
+        }
+        for (size_t i = 0; i < delta.present.size(); ++i) {
+            size_t index = delta.present[i];
+            if constexpr (std::is_empty_v<Component>) {
+                if (!has<Component>(index)) {
+                    insert(index, Component{});
+                }
+            } else {
+                insert(index, std::move(delta.components[i]));
+            }
+        }
+    }
+
+    template <typename Valid>
+    static bool readIndices(
+        SnapshotReader& reader, Valid& valid, std::vector<size_t>& indices
+    ) {
+        uint64_t count = reader.read<uint64_t>();
+        if (!reader.canRead(count, sizeof(size_t))) {
+            return false;
+        }
+        indices.resize(count);
+        reader.readBlock(std::span<size_t>(indices));
+        if (!std::ranges::all_of(indices, valid)) {
+            reader.fail();
+            return false;
+        }
+        return true;
+    }
+
+    template <typename Component>
+    void saveStorage(SnapshotWriter& writer) const {
+        writer.write<uint64_t>(sizeof(Component));
+        if (auto storage = findStorage<Component>()) {
+            storage->save(writer);
+        } else {
+            StorageOf<Component>().save(writer);
+        }
+    }
+
+    template <typename Component, typename Valid>
+    bool loadStorage(SnapshotReader& reader, Valid& valid) {
+        if (reader.read<uint64_t>() != sizeof(Component)) {
+            reader.fail();
+            return false;
+        }
+        auto& storage = ensureStorage<Component>();
+        if (!storage.load(reader, valid)) {
+            return false;
+        }
+        for (size_t index : storage.indices()) {
+            signatures_.set(index, typeId<Component>());
+        }
+        return true;
+    }
+
+    template <typename... Terms>
+    static SignatureMask makeMask() {
+        SignatureMask mask;
+        (addToMask<Terms>(
+            mask, typename StorageTerm<Terms>::ComponentList{}), ...);
+        return mask;
+    }
+
+    template <typename Term, typename... Components>
+    static void addToMask(SignatureMask& mask, TypeList<Components...>) {
+        if constexpr (StorageTerm<Term>::kDriver) {
+            (mask.require(typeId<Components>()), ...);
+        } else if constexpr (IsWithout<Term>::value) {
+            (mask.exclude(typeId<Components>()), ...);
+        }
+    }
+
+    template <typename... Components>
+    const AbstractGroup* findGroup() const noexcept {
+        const AbstractGroup* group = nullptr;
+        bool owned = (ownedBy<Components>(group) && ...);
+        return owned && group->ownedCount() == sizeof...(Components)
+            ? group
+            : nullptr;
+    }
+
+    template <typename Component>
+    bool ownedBy(const AbstractGroup*& group) const noexcept {
+        auto storage = findStorage<Component>();
+        if (!storage || !storage->group()) {
+            return false;
+        }
+        if (!group) {
+            group = storage->group();
+        }
+        return storage->group() == group;
+    }
 
     template <typename Component>
-    static std::type_index key() {
-        static std::type_index index(typeid(Component));
-        return index;
+    bool ownedByAny() const noexcept {
+        auto storage = findStorage<Component>();
+        return storage && storage->group();
+    }
+
+    template <typename... Components, typename Func>
+    void eachInGroup(size_t size, Func& func) {
+        using First = std::tuple_element_t<0, std::tuple<Components...>>;
+        auto indices = ensureStorage<First>().indices();
+        auto components = std::make_tuple(
+            ensureStorage<Components>().components(size)...);
+        for (size_t i = 0; i < size; ++i) {
+            std::apply(
+                [&](auto&... spans) { func(indices[i], spans[i]...); },
+                components);
+        }
     }
 
     template <typename Component>
-    static ComponentStorage<Component>& as(AbstractComponentStorage& storage) {
-        assert(dynamic_cast<ComponentStorage<Component>*>(&storage));
-        return reinterpret_cast<ComponentStorage<Component>&>(storage);
+    const StorageOf<Component>* findStorage() const noexcept {
+        size_t id = typeId<Component>();
+        return id < storages_.size()
+            ? static_cast<const StorageOf<Component>*>(storages_[id].get())
+            : nullptr;
     }
 
     template <typename Component>
-    ComponentStorage<Component>& getStorage() {
-        auto it = storages_.find(key<Component>());
-        assert(it != storages_.end());
-        return as<Component>(*it->second);
+    StorageOf<Component>& getStorage() noexcept {
+        size_t id = typeId<Component>();
+        assert(id < storages_.size() && storages_[id]);
+        return static_cast<StorageOf<Component>&>(*storages_[id]);
+    }
+
+    template <typename... Terms>
+    static constexpr bool isSingleStorage() noexcept {
+        if constexpr (sizeof...(Terms) == 1) {
+            return (std::is_same_v<
+                typename StorageTerm<Terms>::ComponentList,
+                TypeList<Terms>> && ...);
+        } else {
+            return false;
+        }
+    }
+
+    template <typename... Terms>
+    static constexpr bool isGroupable() noexcept {
+        return ((std::is_same_v<
+            typename StorageTerm<Terms>::ComponentList,
+            TypeList<Terms>> && !std::is_empty_v<Terms>) && ...);
+    }
+
+    template <typename Term>
+    StorageTerm<Term> makeTerm(Tick since) {
+        return makeTermFrom<Term>(
+            since, typename StorageTerm<Term>::ComponentList{});
+    }
+
+    template <typename Term, typename... Components>
+    StorageTerm<Term> makeTermFrom(Tick since, TypeList<Components...>) {
+        if constexpr (std::is_constructible_v<
+            StorageTerm<Term>, ComponentStorage<Components>*..., Tick>
+        ) {
+            return StorageTerm<Term>(&ensureStorage<Components>()..., since);
+        } else {
+            return StorageTerm<Term>(&ensureStorage<Components>()...);
+        }
     }
 
     template <typename Component>
-    ComponentStorage<Component>& ensureStorage() {
-        auto k = key<Component>();
-        auto it = storages_.find(k);
-        if (it == storages_.end()) {
-            auto result = storages_.emplace(
-                k,
-                std::make_unique<ComponentStorage<Component>>());
-            assert(result.second == true);
-            it = result.first;
+    StorageOf<Component>& ensureStorage() {
+        size_t id = typeId<Component>();
+        if (id >= storages_.size()) {
+            storages_.resize(id + 1);
+        }
+        if (!storages_[id]) {
+            storages_[id] = std::make_unique<StorageOf<Component>>(
+                storages_.get_allocator().resource());
+            storages_[id]->setTick(tick_);
         }
-        return as<Component>(*it->second);
+        return static_cast<StorageOf<Component>&>(*storages_[id]);
     }
 };
 
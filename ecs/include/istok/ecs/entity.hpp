@@ -1,14 +1,20 @@
 // Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
 #pragma once
 
+#include <algorithm>
 #include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <format>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "snapshot.hpp"
+#include "term.hpp"
+
 
 namespace Istok::ECS {
 
@@ -76,15 +82,35 @@ public:
         return index_ == other.index_ && generation_ == other.generation_;
     }
 
+    bool operator==(const EntityEntry& other) const = default;
+
 private:
     int32_t index_;
     int32_t generation_;
 };
 
 
+// Entity table of a delta read ahead of applying it,
+// see EntityManager::readDelta().
+struct EntityDelta {
+    std::vector<size_t> indices;
+    std::vector<EntityEntry> table;
+    size_t freeIndex = 0;
+
+    // Whether the index belongs to a live entity once applied.
+    bool contains(size_t index) const noexcept {
+        return index < table.size() && !table[index].isLink();
+    }
+};
+
+
 class EntityManager final {
 public:
     EntityManager() = default;
+
+    explicit EntityManager(std::pmr::memory_resource* resource)
+    : entities_(resource), ticks_(resource) {}
+
     ~EntityManager() = default;
 
     EntityManager(const EntityManager&) = delete;
@@ -97,32 +123,212 @@ public:
             && entities_[entity.index_] == entity;
     }
 
+    bool empty() const noexcept {
+        return entities_.empty();
+    }
+
+    // Whether the index belongs to a live entity.
+    bool contains(size_t index) const noexcept {
+        return index < entities_.size() && !entities_[index].isLink();
+    }
+
     Entity get(size_t index) const noexcept {
         assert(index < entities_.size());
         assert(!entities_[index].isLink());
         return entities_[index].entity();
     }
 
+    // Entries changed during the tick are stamped with it,
+    // see saveDelta().
+    void setTick(Tick tick) noexcept {
+        tick_ = tick;
+    }
+
     Entity create() noexcept {
         if (freeIndex_ == entities_.size()) {
             entities_.emplace_back(freeIndex_);
+            ticks_.push_back(tick_);
             return entities_[freeIndex_++].entity();
         }
         auto index = freeIndex_;
         freeIndex_ = entities_[index].link();
         entities_[index].setEntity(index);
+        ticks_[index] = tick_;
         return entities_[index].entity();
     }
 
+    // Room for count more entities, for the case the free list is empty.
+    void reserve(size_t count) {
+        size_t required = entities_.size() + count;
+        if (required > entities_.capacity()) {
+            size_t capacity = std::max(required, 2 * entities_.capacity());
+            entities_.reserve(capacity);
+            ticks_.reserve(capacity);
+        }
+    }
+
     void remove(Entity entity) noexcept {
         assert(isValid(entity));
         entities_[entity.index_].setLink(freeIndex_);
+        ticks_[entity.index_] = tick_;
         freeIndex_ = entity.index_;
     }
 
+    void clear() noexcept {
+        entities_.clear();
+        ticks_.clear();
+        freeIndex_ = 0;
+    }
+
+    // Entries with their generations and the free list as a block.
+    void save(SnapshotWriter& writer) const {
+        writer.write<uint64_t>(entities_.size());
+        writer.write<uint64_t>(freeIndex_);
+        writer.writeBlock(std::span<const EntityEntry>(entities_));
+    }
+
+    // Returns false and stays empty if the data is malformed.
+    bool load(SnapshotReader& reader) {
+        assert(empty());
+        uint64_t count = reader.read<uint64_t>();
+        uint64_t freeIndex = reader.read<uint64_t>();
+        if (!reader.canRead(count, sizeof(EntityEntry)) || freeIndex > count) {
+            reader.fail();
+            return false;
+        }
+        entities_.resize(count, EntityEntry(0));
+        reader.readBlock(std::span<EntityEntry>(entities_));
+        ticks_.assign(count, 0);
+        freeIndex_ = freeIndex;
+        for (size_t index = 0; index < count; ++index) {
+            const EntityEntry& entry = entities_[index];
+            if (entry.isLink()
+                ? entry.link() > count
+                : entry.entity().index() != index
+            ) {
+                reader.fail();
+            }
+        }
+        if (reader.failed() || !isFreeListValid(entities_, freeIndex_)) {
+            reader.fail();
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+    // Table size, free list head and the entries changed after since.
+    void saveDelta(SnapshotWriter& writer, Tick since) const {
+        std::vector<size_t> indices;
+        std::vector<EntityEntry> entries;
+        for (size_t index = 0; index < entities_.size(); ++index) {
+            if (ticks_[index] > since) {
+                indices.push_back(index);
+                entries.push_back(entities_[index]);
+            }
+        }
+        writer.write<uint64_t>(entities_.size());
+        writer.write<uint64_t>(freeIndex_);
+        writer.write<uint64_t>(indices.size());
+        writer.writeBlock(std::span<const size_t>(indices));
+        writer.writeBlock(std::span<const EntityEntry>(entries));
+    }
+
+    // Reads a delta saved by saveDelta() into the merged entry table
+    // without changing anything. Returns false if the data is malformed
+    // or the resulting free list is broken.
+    bool readDelta(SnapshotReader& reader, EntityDelta& delta) const {
+        uint64_t count = reader.read<uint64_t>();
+        uint64_t freeIndex = reader.read<uint64_t>();
+        uint64_t changed = reader.read<uint64_t>();
+        // Appended entries must all be present, so their number is
+        // checked before the table is allocated.
+        if (!reader.canRead(changed, sizeof(size_t) + sizeof(EntityEntry))
+            || count < entities_.size() || count - entities_.size() > changed
+            || freeIndex > count
+        ) {
+            reader.fail();
+            return false;
+        }
+        delta.indices.resize(changed);
+        std::vector<EntityEntry> entries(changed, EntityEntry(0));
+        reader.readBlock(std::span<size_t>(delta.indices));
+        reader.readBlock(std::span<EntityEntry>(entries));
+        delta.table.assign(entities_.begin(), entities_.end());
+        delta.table.resize(count, EntityEntry(0));
+        std::vector<bool> seen(count);
+        for (size_t i = 0; i < changed && !reader.failed(); ++i) {
+            size_t index = delta.indices[i];
+            const EntityEntry& entry = entries[i];
+            if (index >= count || seen[index] || (entry.isLink()
+                ? entry.link() > count
+                : entry.entity().index() != index)
+            ) {
+                reader.fail();
+                break;
+            }
+            seen[index] = true;
+            delta.table[index] = entry;
+        }
+        if (reader.failed()
+            || !std::all_of(
+                seen.begin() + entities_.size(), seen.end(),
+                [](bool value) { return value; })
+            || !isFreeListValid(delta.table, freeIndex)
+        ) {
+            reader.fail();
+            return false;
+        }
+        delta.freeIndex = freeIndex;
+        return true;
+    }
+
+    // Replaces the table with the one read by readDelta(), calling
+    // onDestroy(index) first for every live entity replaced by a link
+    // or a newer generation.
+    template <typename Func>
+    void applyDelta(const EntityDelta& delta, Func&& onDestroy) {
+        for (size_t index : delta.indices) {
+            if (contains(index) && !(entities_[index] == delta.table[index])) {
+                onDestroy(index);
+            }
+        }
+        entities_.assign(delta.table.begin(), delta.table.end());
+        ticks_.resize(entities_.size(), tick_);
+        for (size_t index : delta.indices) {
+            ticks_[index] = tick_;
+        }
+        freeIndex_ = delta.freeIndex;
+    }
+
+private:
+    // The free list from freeIndex visits every link entry once
+    // and ends at the table size.
+    static bool isFreeListValid(
+        std::span<const EntityEntry> entries, size_t freeIndex
+    ) {
+        std::vector<bool> visited(entries.size());
+        size_t links = 0;
+        for (size_t index = freeIndex; index != entries.size();
+            index = entries[index].link()
+        ) {
+            if (!entries[index].isLink() || visited[index]) {
+                return false;
+            }
+            visited[index] = true;
+            ++links;
+        }
+        return links == static_cast<size_t>(std::ranges::count_if(
+            entries, [](const EntityEntry& entry) {
+                return entry.isLink();
+            }));
+    }
+
 private:
-    std::vector<EntityEntry> entities_;
+    std::pmr::vector<EntityEntry> entities_;
+    std::pmr::vector<Tick> ticks_;
     size_t freeIndex_ = 0;
+    Tick tick_ = 1;
 };
 
 }  // namespace Internal
@@ -0,0 +1,253 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "entity.hpp"
+
+namespace Istok::ECS {
+
+namespace Internal {
+    class Hierarchy;
+}
+
+// Links of an entity in the parent-child hierarchy, managed by
+// ECSManager::setParent() and removeParent(). Children form a doubly
+// linked list, so reparenting is O(1). ECSManager rejects inserting,
+// removing and mutably accessing nodes, which would break the links.
+class HierarchyNode final {
+public:
+    HierarchyNode() = default;
+
+    std::optional<Entity> parent() const noexcept {
+        return parent_;
+    }
+
+    bool isRoot() const noexcept {
+        return !parent_;
+    }
+
+private:
+    friend class Internal::Hierarchy;
+
+    static constexpr size_t kNone = SIZE_MAX;
+
+    std::optional<Entity> parent_;
+    size_t firstChild_ = kNone;
+    size_t prevSibling_ = kNone;
+    size_t nextSibling_ = kNone;
+};
+
+
+namespace Internal {
+
+// Hierarchy operations over the HierarchyNode components of a component
+// backend. The node storage is reordered depth-first on demand,
+// parents first, so that a traversal is a single pass over it.
+class Hierarchy {
+public:
+    template <typename Backend>
+    void setParent(Backend& components, size_t child, Entity parentEntity) {
+        size_t parent = parentEntity.index();
+        assert(child != parent);
+        ensureNode(components, child);
+        ensureNode(components, parent);
+        assert(!isAncestor(components, child, parent));
+        detach(components, child);
+        HierarchyNode& parentNode = node(components, parent);
+        HierarchyNode& childNode = node(components, child);
+        childNode.parent_ = parentEntity;
+        childNode.nextSibling_ = parentNode.firstChild_;
+        if (parentNode.firstChild_ != HierarchyNode::kNone) {
+            node(components, parentNode.firstChild_).prevSibling_ = child;
+        }
+        parentNode.firstChild_ = child;
+        sorted_ = false;
+    }
+
+    template <typename Backend>
+    void removeParent(Backend& components, size_t child) {
+        if (components.template has<HierarchyNode>(child)) {
+            detach(components, child);
+            sorted_ = false;
+        }
+    }
+
+    template <typename Backend>
+    std::optional<Entity> parent(
+        const Backend& components, size_t child
+    ) const noexcept {
+        if (!components.template has<HierarchyNode>(child)) {
+            return std::nullopt;
+        }
+        return constNode(components, child).parent_;
+    }
+
+    // Calls func(child) for every child, the most recent first.
+    template <typename Backend, typename Func>
+    void eachChild(const Backend& components, size_t parent, Func&& func) {
+        if (!components.template has<HierarchyNode>(parent)) {
+            return;
+        }
+        size_t child = constNode(components, parent).firstChild_;
+        while (child != HierarchyNode::kNone) {
+            size_t next = constNode(components, child).nextSibling_;
+            func(child);
+            child = next;
+        }
+    }
+
+    // Unlinks the node of a removed index, its children become roots.
+    template <typename Backend>
+    void remove(Backend& components, size_t index) {
+        if (!components.template has<HierarchyNode>(index)) {
+            return;
+        }
+        detach(components, index);
+        size_t child = node(components, index).firstChild_;
+        while (child != HierarchyNode::kNone) {
+            HierarchyNode& childNode = node(components, child);
+            child = childNode.nextSibling_;
+            childNode.parent_.reset();
+            childNode.prevSibling_ = HierarchyNode::kNone;
+            childNode.nextSibling_ = HierarchyNode::kNone;
+        }
+        node(components, index).firstChild_ = HierarchyNode::kNone;
+        sorted_ = false;
+    }
+
+    // Nodes changed bypassing the hierarchy, e.g. by a snapshot.
+    void invalidate() noexcept {
+        sorted_ = false;
+    }
+
+    // Calls func(index, parent) for every node, parents before
+    // their descendants, in the dense order of the node storage.
+    // The parent is empty for roots.
+    template <typename Backend, typename Func>
+    void each(Backend& components, Func&& func) {
+        if (!sorted_) {
+            std::vector<size_t> order = preorder(components);
+            sorted_ = components.template sortAs<HierarchyNode>(order);
+            // The storage keeps the order of its owning group.
+            if (!sorted_) {
+                for (size_t index : order) {
+                    func(index, constNode(components, index).parent_);
+                }
+                return;
+            }
+        }
+        for (size_t index : components.template view<HierarchyNode>()) {
+            func(index, constNode(components, index).parent_);
+        }
+    }
+
+private:
+    bool sorted_ = true;
+
+    template <typename Backend>
+    static HierarchyNode& node(Backend& components, size_t index) noexcept {
+        return components.template get<HierarchyNode>(index);
+    }
+
+    template <typename Backend>
+    static const HierarchyNode& constNode(
+        const Backend& components, size_t index
+    ) noexcept {
+        return components.template get<const HierarchyNode>(index);
+    }
+
+    template <typename Backend>
+    static std::optional<size_t> parentIndex(
+        const Backend& components, size_t index
+    ) noexcept {
+        const auto& parent = constNode(components, index).parent_;
+        return parent ? std::optional<size_t>(parent->index()) : std::nullopt;
+    }
+
+    template <typename Backend>
+    void ensureNode(Backend& components, size_t index) {
+        if (!components.template has<HierarchyNode>(index)) {
+            components.insert(index, HierarchyNode());
+            sorted_ = false;
+        }
+    }
+
+    template <typename Backend>
+    static bool isAncestor(
+        const Backend& components, size_t ancestor, size_t index
+    ) noexcept {
+        std::optional<size_t> current = index;
+        while (current) {
+            if (*current == ancestor) {
+                return true;
+            }
+            current = parentIndex(components, *current);
+        }
+        return false;
+    }
+
+    template <typename Backend>
+    static void detach(Backend& components, size_t index) {
+        HierarchyNode& indexNode = node(components, index);
+        if (!indexNode.parent_) {
+            return;
+        }
+        if (indexNode.prevSibling_ != HierarchyNode::kNone) {
+            node(components, indexNode.prevSibling_).nextSibling_ =
+                indexNode.nextSibling_;
+        } else {
+            node(components, indexNode.parent_->index()).firstChild_ =
+                indexNode.nextSibling_;
+        }
+        if (indexNode.nextSibling_ != HierarchyNode::kNone) {
+            node(components, indexNode.nextSibling_).prevSibling_ =
+                indexNode.prevSibling_;
+        }
+        indexNode.parent_.reset();
+        indexNode.prevSibling_ = HierarchyNode::kNone;
+        indexNode.nextSibling_ = HierarchyNode::kNone;
+    }
+
+    // Pre-order walk from every root following the links.
+    template <typename Backend>
+    static std::vector<size_t> preorder(Backend& components) {
+        auto indices = components.template view<HierarchyNode>();
+        std::vector<size_t> order;
+        order.reserve(indices.size());
+        for (size_t root : indices) {
+            if (!constNode(components, root).isRoot()) {
+                continue;
+            }
+            size_t current = root;
+            while (true) {
+                order.push_back(current);
+                const HierarchyNode& currentNode =
+                    constNode(components, current);
+                if (currentNode.firstChild_ != HierarchyNode::kNone) {
+                    current = currentNode.firstChild_;
+                    continue;
+                }
+                while (current != root && constNode(components, current)
+                    .nextSibling_ == HierarchyNode::kNone
+                ) {
+                    current = *parentIndex(components, current);
+                }
+                if (current == root) {
+                    break;
+                }
+                current = constNode(components, current).nextSibling_;
+            }
+        }
+        assert(order.size() == indices.size());
+        return order;
+    }
+};
+
+}  // namespace Internal
+
+}  // namespace Istok::ECS
@@ -0,0 +1,91 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "type_id.hpp"
+
+namespace Istok::ECS::Internal {
+
+class AbstractResource {
+public:
+    virtual ~AbstractResource() = default;
+};
+
+template <typename T>
+class Resource : public AbstractResource {
+public:
+    template <typename... Args>
+    explicit Resource(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    T value;
+};
+
+
+// Single instances of types indexed by their dense type ids, so a lookup
+// is a bounds check and a pointer load. Resources are constructed
+// in place and keep their address until replaced or removed.
+class ResourceManager {
+public:
+    ResourceManager() = default;
+
+    explicit ResourceManager(std::pmr::memory_resource* resource)
+    : resources_(resource) {}
+
+    ~ResourceManager() = default;
+
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+    ResourceManager(ResourceManager&&) noexcept = default;
+    ResourceManager& operator=(ResourceManager&&) noexcept = default;
+
+    template <typename T, typename... Args>
+    T& set(Args&&... args) {
+        static_assert(std::is_same_v<T, std::remove_cvref_t<T>>);
+        size_t id = typeId<T>();
+        if (id >= resources_.size()) {
+            resources_.resize(id + 1);
+        }
+        auto resource =
+            std::make_unique<Resource<T>>(std::forward<Args>(args)...);
+        T& value = resource->value;
+        resources_[id] = std::move(resource);
+        return value;
+    }
+
+    template <typename T>
+    T* find() noexcept {
+        return const_cast<T*>(std::as_const(*this).find<T>());
+    }
+
+    template <typename T>
+    const T* find() const noexcept {
+        size_t id = typeId<T>();
+        if (id >= resources_.size() || !resources_[id]) {
+            return nullptr;
+        }
+        return &static_cast<const Resource<T>*>(resources_[id].get())->value;
+    }
+
+    template <typename T>
+    void remove() noexcept {
+        size_t id = typeId<T>();
+        if (id < resources_.size()) {
+            resources_[id].reset();
+        }
+    }
+
+    void clear() noexcept {
+        resources_.clear();
+    }
+
+private:
+    std::pmr::vector<std::unique_ptr<AbstractResource>> resources_;
+};
+
+}  // namespace Istok::ECS::Internal
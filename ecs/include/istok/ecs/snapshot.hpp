@@ -0,0 +1,141 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace Istok::ECS {
+
+// In-memory sink of a world snapshot. Values are written as raw bytes
+// in the native byte order, so snapshots are meant to be read back
+// by the same build.
+class SnapshotWriter {
+public:
+    const std::vector<std::byte>& data() const noexcept {
+        return data_;
+    }
+
+    void writeBytes(const void* source, size_t size) {
+        auto bytes = static_cast<const std::byte*>(source);
+        data_.insert(data_.end(), bytes, bytes + size);
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void write(const T& value) {
+        writeBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void writeBlock(std::span<const T> values) {
+        writeBytes(values.data(), values.size_bytes());
+    }
+
+private:
+    std::vector<std::byte> data_;
+};
+
+
+// Source of a snapshot. Reading past the end fails the reader and yields
+// zero bytes, so truncated data can be checked for once at the end.
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::span<const std::byte> data) noexcept
+    : data_(data) {}
+
+    bool failed() const noexcept {
+        return failed_;
+    }
+
+    size_t remaining() const noexcept {
+        return data_.size() - position_;
+    }
+
+    void fail() noexcept {
+        failed_ = true;
+    }
+
+    bool readBytes(void* target, size_t size) noexcept {
+        if (failed_ || size > remaining()) {
+            failed_ = true;
+            if (size) {
+                std::memset(target, 0, size);
+            }
+            return false;
+        }
+        if (!size) {
+            return true;
+        }
+        std::memcpy(target, data_.data() + position_, size);
+        position_ += size;
+        return true;
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    T read() noexcept {
+        std::array<std::byte, sizeof(T)> bytes;
+        readBytes(bytes.data(), sizeof(T));
+        return std::bit_cast<T>(bytes);
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void readBlock(std::span<T> values) noexcept {
+        readBytes(values.data(), values.size_bytes());
+    }
+
+    // Guards allocations sized by the input: fails the reader unless
+    // count elements of the given size are left.
+    bool canRead(size_t count, size_t size) noexcept {
+        if (failed_ || (size && count > remaining() / size)) {
+            failed_ = true;
+        }
+        return !failed_;
+    }
+
+private:
+    std::span<const std::byte> data_;
+    size_t position_ = 0;
+    bool failed_ = false;
+};
+
+
+// Snapshot format of a component type. Trivially copyable components
+// are written as one block of bytes, other ones need a specialization
+//     static void write(SnapshotWriter& writer, const T& value);
+//     static T read(SnapshotReader& reader);
+template <typename T>
+struct Serializer {};
+
+
+namespace Internal {
+
+template <typename T>
+concept CustomSerialized = requires(
+    SnapshotWriter& writer, SnapshotReader& reader, const T& value
+) {
+    Serializer<T>::write(writer, value);
+    { Serializer<T>::read(reader) } -> std::same_as<T>;
+};
+
+template <typename T>
+concept Serializable = CustomSerialized<T>
+    || (std::is_trivially_copyable_v<T>
+        && std::is_default_constructible_v<T>);
+
+inline constexpr uint32_t kSnapshotMagic = 0x4b545349;  // "ISTK"
+inline constexpr uint32_t kDeltaMagic = 0x44545349;  // "ISTD"
+inline constexpr uint32_t kSnapshotVersion = 1;
+
+}  // namespace Internal
+
+}  // namespace Istok::ECS
@@ -1,16 +1,31 @@
 // Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <stack>
+#include <utility>
 #include <vector>
 
+#include "type_id.hpp"
+#include "thread_pool.hpp"
+
 
 namespace Istok::ECS {
 
 using Closure = std::move_only_function<void() noexcept>;
 
+// Access terms of scheduled systems.
+template <typename... Components>
+struct Read {};
+
+template <typename... Components>
+struct Write {};
+
 namespace Internal {
 
 class ClosureLoop {
@@ -127,6 +142,170 @@ private:
 };
 
 
+// Component types a scheduled system reads and writes.
+class SystemAccess {
+public:
+    template <typename... Terms>
+    static SystemAccess of() {
+        SystemAccess access;
+        (access.add(Terms{}), ...);
+        normalize(access.reads_);
+        normalize(access.writes_);
+        return access;
+    }
+
+    bool conflicts(const SystemAccess& other) const noexcept {
+        return intersects(writes_, other.writes_)
+            || intersects(writes_, other.reads_)
+            || intersects(reads_, other.writes_);
+    }
+
+private:
+    std::vector<size_t> reads_;
+    std::vector<size_t> writes_;
+
+    template <typename... Components>
+    void add(Read<Components...>) {
+        (reads_.push_back(typeId<Components>()), ...);
+    }
+
+    template <typename... Components>
+    void add(Write<Components...>) {
+        (writes_.push_back(typeId<Components>()), ...);
+    }
+
+    static void normalize(std::vector<size_t>& ids) {
+        std::ranges::sort(ids);
+        ids.erase(std::ranges::unique(ids).begin(), ids.end());
+    }
+
+    static bool intersects(
+        const std::vector<size_t>& a, const std::vector<size_t>& b
+    ) noexcept {
+        auto i = a.begin();
+        auto j = b.begin();
+        while (i != a.end() && j != b.end()) {
+            if (*i == *j) {
+                return true;
+            }
+            if (*i < *j) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+        return false;
+    }
+};
+
+
+// Scheduled systems running on the pool. Every system waits for
+// the earlier systems it conflicts with, so the dependencies form
+// a DAG ordered by insertion. Ready systems start in insertion order.
+class ParallelStage {
+public:
+    explicit ParallelStage(ThreadPool& pool) noexcept : pool_(pool) {}
+
+    ~ParallelStage() {
+        while (!nodes_.empty()) {
+            nodes_.pop_back();
+        }
+    }
+
+    ParallelStage(const ParallelStage&) = delete;
+    ParallelStage& operator=(const ParallelStage&) = delete;
+    ParallelStage(ParallelStage&&) = delete;
+    ParallelStage& operator=(ParallelStage&&) = delete;
+
+    void add(SystemAccess&& access, Closure&& system) noexcept {
+        size_t index = nodes_.size();
+        Node node{std::move(access), std::move(system)};
+        for (size_t i = 0; i < index; ++i) {
+            if (nodes_[i].access.conflicts(node.access)) {
+                nodes_[i].successors.push_back(index);
+                ++node.dependencyCount;
+            }
+        }
+        nodes_.push_back(std::move(node));
+    }
+
+    void run() noexcept {
+        Frame frame(nodes_.size());
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            frame.remaining[i].store(
+                nodes_[i].dependencyCount, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            if (nodes_[i].dependencyCount == 0) {
+                schedule(frame, i);
+            }
+        }
+        pool_.wait(frame.group);
+    }
+
+    // True on a thread executing a scheduled system.
+    static bool isRunningSystem() noexcept {
+        return runningSystem();
+    }
+
+private:
+    struct Node {
+        SystemAccess access;
+        Closure system;
+        std::vector<size_t> successors = {};
+        size_t dependencyCount = 0;
+    };
+
+    struct Frame {
+        explicit Frame(size_t size)
+            : remaining(std::make_unique<std::atomic<size_t>[]>(size)) {}
+
+        TaskGroup group;
+        std::unique_ptr<std::atomic<size_t>[]> remaining;
+        std::mutex mutex;
+        std::priority_queue<size_t, std::vector<size_t>, std::greater<>>
+            ready;
+    };
+
+    std::vector<Node> nodes_;
+    ThreadPool& pool_;
+
+    static bool& runningSystem() noexcept {
+        static thread_local bool running = false;
+        return running;
+    }
+
+    // Every task runs the earliest ready system rather than a fixed one.
+    void schedule(Frame& frame, size_t index) noexcept {
+        {
+            std::lock_guard lock(frame.mutex);
+            frame.ready.push(index);
+        }
+        pool_.submit(
+            frame.group, [this, &frame]() noexcept { runNext(frame); });
+    }
+
+    void runNext(Frame& frame) noexcept {
+        size_t index;
+        {
+            std::lock_guard lock(frame.mutex);
+            index = frame.ready.top();
+            frame.ready.pop();
+        }
+        bool outer = std::exchange(runningSystem(), true);
+        nodes_[index].system();
+        runningSystem() = outer;
+        for (size_t next : nodes_[index].successors) {
+            if (frame.remaining[next].fetch_sub(
+                    1, std::memory_order_acq_rel) == 1
+            ) {
+                schedule(frame, next);
+            }
+        }
+    }
+};
+
+
 class SystemManager {
 public:
     SystemManager() = default;
@@ -141,9 +320,24 @@ public:
     SystemManager& operator=(SystemManager&&) = default;
 
     void addLoop(Closure&& system) noexcept {
+        stage_ = nullptr;
         loopSystems_.add(std::move(system));
     }
 
+    // Consecutive scheduled systems share a parallel stage,
+    // any other loop system ends it.
+    void addLoop(
+        SystemAccess&& access, Closure&& system, ThreadPool& pool
+    ) noexcept {
+        if (!stage_) {
+            auto stage = std::make_unique<ParallelStage>(pool);
+            stage_ = stage.get();
+            loopSystems_.add(
+                [stage=std::move(stage)]() noexcept { stage->run(); });
+        }
+        stage_->add(std::move(access), std::move(system));
+    }
+
     void addHead(Closure&& system) noexcept {
         headCleanupSystems_.add(std::move(system));
     }
@@ -156,12 +350,18 @@ public:
         loopSystems_.iterate();
     }
 
+    // Ignored in scheduled systems since the rest of their stage
+    // may still be running.
     void pass() noexcept {
+        if (ParallelStage::isRunningSystem()) {
+            return;
+        }
         loopSystems_.pass();
     }
 
     void clear() noexcept {
         loopSystems_.clear();
+        stage_ = nullptr;
         headCleanupSystems_.launch();
         tailCleanupSystems_.launch();
     }
@@ -170,6 +370,7 @@ private:
     Internal::ClosureLoop loopSystems_;
     Internal::ClosureQueue headCleanupSystems_;
     Internal::ClosureStack tailCleanupSystems_;
+    ParallelStage* stage_ = nullptr;
 };
 
 }  // namespace Internal
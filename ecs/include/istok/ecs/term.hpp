@@ -0,0 +1,37 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <cstdint>
+
+namespace Istok::ECS {
+
+// Change counter of the component storages, see advanceTick().
+using Tick = uint32_t;
+
+// View term matching entities that have none of the components.
+template <typename... Components>
+struct Without {};
+
+// View term passing a pointer to the component, null if it is absent.
+template <typename Component>
+struct Optional {};
+
+// View terms matching components inserted (Added) or inserted or
+// mutably accessed (Changed) after the tick passed to the view,
+// both pass a read-only reference. A const component term passes
+// a read-only reference that is not counted as a change, while
+// a non-const one counts every visited component as changed.
+template <typename Component>
+struct Added {};
+
+template <typename Component>
+struct Changed {};
+
+namespace Internal {
+
+template <typename... Ts>
+struct TypeList {};
+
+}  // namespace Internal
+
+}  // namespace Istok::ECS
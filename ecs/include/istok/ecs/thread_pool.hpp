@@ -0,0 +1,282 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Istok::ECS::Internal {
+
+class TaskGroup {
+public:
+    TaskGroup() = default;
+
+    ~TaskGroup() {
+        assert(pending_.load() == 0);
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    TaskGroup(TaskGroup&&) = delete;
+    TaskGroup& operator=(TaskGroup&&) = delete;
+
+    bool done() const noexcept {
+        return pending_.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class ThreadPool;
+    std::atomic<size_t> pending_ = 0;
+};
+
+
+// Work-stealing pool: every worker owns a task deque, pops its own
+// tasks LIFO and steals from the other deques FIFO when idle.
+// Threads waiting for a task group execute pending tasks meanwhile,
+// so a pool without workers runs everything on the waiting thread.
+class ThreadPool {
+public:
+    using Task = std::move_only_function<void() noexcept>;
+
+    static size_t defaultWorkerCount() noexcept {
+        size_t hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+
+    // Workers are started by the first submitted task.
+    explicit ThreadPool(size_t workerCount = defaultWorkerCount()) noexcept
+        : workerCount_(workerCount) {}
+
+    ~ThreadPool() {
+        stop();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    size_t workerCount() const noexcept {
+        return workerCount_;
+    }
+
+    // Number of threads taking part in a wait: workers and the caller.
+    size_t concurrency() const noexcept {
+        return workerCount_ + 1;
+    }
+
+    // Stops the running workers, the new ones start on demand.
+    // Must not be called while any task group is pending.
+    void setWorkerCount(size_t workerCount) {
+        stop();
+        workerCount_ = workerCount;
+    }
+
+    void submit(TaskGroup& group, Task&& task) {
+        start();
+        group.pending_.fetch_add(1, std::memory_order_relaxed);
+        push([this, &group, task=std::move(task)]() mutable noexcept {
+            task();
+            if (group.pending_.fetch_sub(1, std::memory_order_acq_rel)
+                == 1
+            ) {
+                std::lock_guard lock(sleepMutex_);
+                wake_.notify_all();
+            }
+        });
+    }
+
+    void wait(TaskGroup& group) noexcept {
+        while (!group.done()) {
+            if (runOne()) {
+                continue;
+            }
+            sleep([&group] { return group.done(); });
+        }
+    }
+
+    // Calls func(begin, end) for consecutive chunks of [0, count)
+    // and returns when all of them are done.
+    template <typename Func>
+    void parallelFor(size_t count, size_t chunkSize, Func&& func) {
+        assert(chunkSize > 0);
+        if (count <= chunkSize) {
+            if (count > 0) {
+                func(size_t{0}, count);
+            }
+            return;
+        }
+        TaskGroup group;
+        for (size_t begin = 0; begin < count; begin += chunkSize) {
+            size_t end = std::min(begin + chunkSize, count);
+            submit(group, [&func, begin, end]() noexcept {
+                func(begin, end); });
+        }
+        wait(group);
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    size_t workerCount_;
+    std::atomic<bool> started_ = false;
+    std::mutex startMutex_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    // Pushes and pops only touch the counters, the mutex is taken
+    // to park a thread or to wake the parked ones.
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_ = 0;
+    std::atomic<size_t> sleepers_ = 0;
+    bool stopping_ = false;
+    std::atomic<size_t> nextQueue_ = 0;
+
+    static constexpr size_t kNoWorker = SIZE_MAX;
+
+    struct WorkerSlot {
+        const ThreadPool* pool = nullptr;
+        size_t index = kNoWorker;
+    };
+
+    static WorkerSlot& currentWorker() noexcept {
+        static thread_local WorkerSlot slot;
+        return slot;
+    }
+
+    size_t ownQueue() const noexcept {
+        const WorkerSlot& slot = currentWorker();
+        return slot.pool == this ? slot.index : kNoWorker;
+    }
+
+    void start() {
+        if (started_.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard lock(startMutex_);
+        if (started_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        size_t queueCount = std::max<size_t>(workerCount_, 1);
+        for (size_t i = 0; i < queueCount; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < workerCount_; ++i) {
+            workers_.emplace_back([this, i] { work(i); });
+        }
+        started_.store(true, std::memory_order_release);
+    }
+
+    void stop() {
+        if (!started_.load(std::memory_order_acquire)) {
+            return;
+        }
+        {
+            std::lock_guard lock(sleepMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        assert(queued_.load() == 0);
+        workers_.clear();
+        queues_.clear();
+        stopping_ = false;
+        started_.store(false, std::memory_order_release);
+    }
+
+    void push(Task&& task) {
+        size_t target = ownQueue();
+        if (target == kNoWorker) {
+            target = nextQueue_.fetch_add(1, std::memory_order_relaxed)
+                % queues_.size();
+        }
+        // Counted first, so that the counter never falls below
+        // the number of queued tasks.
+        queued_.fetch_add(1);
+        {
+            std::lock_guard lock(queues_[target]->mutex);
+            queues_[target]->tasks.push_back(std::move(task));
+        }
+        // Pairs with the sleeper registration in sleep(): either
+        // the sleeper sees the task or this sees the sleeper.
+        if (sleepers_.load() > 0) {
+            std::lock_guard lock(sleepMutex_);
+            wake_.notify_one();
+        }
+    }
+
+    std::optional<Task> pop() noexcept {
+        size_t own = ownQueue();
+        if (own != kNoWorker) {
+            std::lock_guard lock(queues_[own]->mutex);
+            if (!queues_[own]->tasks.empty()) {
+                Task task = std::move(queues_[own]->tasks.back());
+                queues_[own]->tasks.pop_back();
+                return task;
+            }
+        }
+        size_t start = own == kNoWorker ? 0 : own + 1;
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            Queue& victim = *queues_[(start + i) % queues_.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                Task task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool runOne() noexcept {
+        std::optional<Task> task = pop();
+        if (!task) {
+            return false;
+        }
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        (*task)();
+        return true;
+    }
+
+    // Parks the thread until a task is queued or ready() holds and
+    // returns ready(). A change of ready() must be followed by
+    // a notification with sleepMutex_ held.
+    template <typename Ready>
+    bool sleep(Ready&& ready) noexcept {
+        std::unique_lock lock(sleepMutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [this, &ready] {
+            return queued_.load() > 0 || ready(); });
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        return ready();
+    }
+
+    void work(size_t index) noexcept {
+        currentWorker() = WorkerSlot{this, index};
+        while (true) {
+            if (runOne()) {
+                continue;
+            }
+            if (sleep([this] { return stopping_; }) && queued_.load() == 0) {
+                return;
+            }
+        }
+    }
+};
+
+}  // namespace Istok::ECS::Internal
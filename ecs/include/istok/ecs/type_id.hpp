@@ -0,0 +1,39 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace Istok::ECS::Internal {
+
+inline size_t nextTypeId() noexcept {
+    static std::atomic<size_t> counter = 0;
+    return counter++;
+}
+
+// Dense sequential id assigned to each type on first use.
+template <typename T>
+size_t typeId() noexcept {
+    if constexpr (std::is_same_v<T, std::remove_cvref_t<T>>) {
+        static const size_t id = nextTypeId();
+        return id;
+    } else {
+        return typeId<std::remove_cvref_t<T>>();
+    }
+}
+
+inline size_t nextQueryId() noexcept {
+    static std::atomic<size_t> counter = 0;
+    return counter++;
+}
+
+// Dense id of a cached query over the terms, counted apart from
+// the type ids, so that queries do not widen the signature rows.
+template <typename... Terms>
+size_t queryId() noexcept {
+    static const size_t id = nextQueryId();
+    return id;
+}
+
+}  // namespace Istok::ECS::Internal
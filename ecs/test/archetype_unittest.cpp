@@ -0,0 +1,430 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#include "istok/ecs/archetype.hpp"
+
+#include <catch.hpp>
+
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "istok/ecs.hpp"
+
+using namespace Istok::ECS;
+using namespace Istok::ECS::Internal;
+
+
+namespace {
+
+struct A {
+    int value;
+    bool operator==(const A&) const = default;
+};
+
+struct B {
+    int value;
+    bool operator==(const B&) const = default;
+};
+
+struct C {
+    int value;
+    bool operator==(const C&) const = default;
+};
+
+template <typename T>
+std::set<size_t> toSet(T x) {
+    return std::set<size_t>(x.begin(), x.end());
+}
+
+// Sparse-set only features are constrained out of ArchetypeECSManager.
+template <typename Manager>
+concept HasSignals = requires(Manager& ecs, Entity entity) {
+    ecs.template onConstruct<A>([](Entity) {});
+    ecs.template patch<A>(entity, [](A&) {});
+};
+
+template <typename Manager>
+concept HasTicks = requires(Manager& ecs) {
+    ecs.advanceTick();
+    ecs.template view<A>(Tick{0});
+};
+
+template <typename Manager>
+concept HasQueries = requires(Manager& ecs) {
+    ecs.template query<A>();
+};
+
+template <typename Manager>
+concept HasOrdering = requires(Manager& ecs) {
+    ecs.template sort<A>([](const A&, const A&) { return false; });
+    ecs.template sortAs<A, B>();
+};
+
+template <typename Manager>
+concept HasSnapshots = requires(
+    Manager& ecs, SnapshotWriter& writer, SnapshotReader& reader
+) {
+    ecs.template save<A>(writer);
+    ecs.template load<A>(reader);
+    ecs.template saveDelta<A>(writer, Tick{0});
+    ecs.template applyDelta<A>(reader);
+};
+
+template <typename Manager>
+concept HasHierarchy = requires(Manager& ecs, Entity entity) {
+    ecs.setParent(entity, entity);
+    ecs.eachDepthFirst([](Entity, std::optional<Entity>) {});
+};
+
+static_assert(HasSignals<ECSManager>);
+static_assert(!HasSignals<ArchetypeECSManager>);
+static_assert(HasTicks<ECSManager>);
+static_assert(!HasTicks<ArchetypeECSManager>);
+static_assert(HasQueries<ECSManager>);
+static_assert(!HasQueries<ArchetypeECSManager>);
+static_assert(HasOrdering<ECSManager>);
+static_assert(!HasOrdering<ArchetypeECSManager>);
+static_assert(HasHierarchy<ECSManager>);
+static_assert(!HasHierarchy<ArchetypeECSManager>);
+static_assert(HasSnapshots<ECSManager>);
+static_assert(!HasSnapshots<ArchetypeECSManager>);
+
+}  // namespace
+
+
+TEST_CASE("ArchetypeManager - basic", "[unit][ecs]") {
+    ArchetypeManager am;
+    REQUIRE(am.count<A>() == 0);
+    REQUIRE(am.count<B>() == 0);
+    REQUIRE(!am.has<A>(0));
+    REQUIRE(!am.has<B>(0));
+
+    SECTION("insert single") {
+        am.insert(0, A{100});
+        REQUIRE(am.count<A>() == 1);
+        REQUIRE(am.has<A>(0));
+        REQUIRE(!am.has<A>(1));
+        REQUIRE(!am.has<B>(0));
+        REQUIRE(am.get<A>(0) == A{100});
+    }
+
+    SECTION("insert multiple components") {
+        am.insert(0, A{100});
+        am.insert(0, B{200});
+        am.insert(1, B{201});
+        am.insert(1, C{301});
+        am.insert(0, C{300});
+        REQUIRE(am.count<A>() == 1);
+        REQUIRE(am.count<B>() == 2);
+        REQUIRE(am.count<C>() == 2);
+        REQUIRE(am.get<A>(0) == A{100});
+        REQUIRE(am.get<B>(0) == B{200});
+        REQUIRE(am.get<C>(0) == C{300});
+        REQUIRE(am.get<B>(1) == B{201});
+        REQUIRE(am.get<C>(1) == C{301});
+    }
+
+    SECTION("replace") {
+        am.insert(0, A{100});
+        am.insert(0, B{200});
+        am.insert(0, A{101});
+        REQUIRE(am.count<A>() == 1);
+        REQUIRE(am.get<A>(0) == A{101});
+        REQUIRE(am.get<B>(0) == B{200});
+    }
+
+    SECTION("remove") {
+        am.insert(0, A{100});
+        am.insert(1, A{101});
+        am.insert(2, A{102});
+        am.insert(0, B{200});
+        am.insert(1, B{201});
+        am.insert(2, B{202});
+        am.remove<A>(0);
+        REQUIRE(am.count<A>() == 2);
+        REQUIRE(am.count<B>() == 3);
+        REQUIRE(!am.has<A>(0));
+        REQUIRE(am.get<A>(1) == A{101});
+        REQUIRE(am.get<A>(2) == A{102});
+        REQUIRE(am.get<B>(0) == B{200});
+        REQUIRE(am.get<B>(1) == B{201});
+        REQUIRE(am.get<B>(2) == B{202});
+        am.remove<B>(0);
+        REQUIRE(am.count<B>() == 2);
+        REQUIRE(!am.has<B>(0));
+    }
+
+    SECTION("remove all") {
+        am.insert(0, A{100});
+        am.insert(1, A{101});
+        am.insert(0, B{200});
+        am.insert(2, B{202});
+        am.removeAll<A>();
+        REQUIRE(am.count<A>() == 0);
+        REQUIRE(am.count<B>() == 2);
+        REQUIRE(!am.has<A>(0));
+        REQUIRE(!am.has<A>(1));
+        REQUIRE(am.get<B>(0) == B{200});
+        REQUIRE(am.get<B>(2) == B{202});
+    }
+
+    SECTION("clear index") {
+        am.insert(0, A{100});
+        am.insert(1, A{101});
+        am.insert(0, B{200});
+        am.insert(1, B{201});
+        am.clearIndex(0);
+        REQUIRE(am.count<A>() == 1);
+        REQUIRE(am.count<B>() == 1);
+        REQUIRE(!am.has<A>(0));
+        REQUIRE(!am.has<B>(0));
+        REQUIRE(am.get<A>(1) == A{101});
+        REQUIRE(am.get<B>(1) == B{201});
+    }
+
+    SECTION("clear") {
+        am.insert(0, A{100});
+        am.insert(1, B{201});
+        am.clear();
+        REQUIRE(am.count<A>() == 0);
+        REQUIRE(am.count<B>() == 0);
+        REQUIRE(!am.has<A>(0));
+        REQUIRE(!am.has<B>(1));
+    }
+}
+
+
+TEST_CASE("ArchetypeManager - view", "[unit][ecs]") {
+    ArchetypeManager am;
+    REQUIRE(toSet(am.view<A>()) == std::set<size_t>{});
+
+    am.insert(0, A{0});
+    am.insert(1, A{0});
+    am.insert(2, A{0});
+    am.insert(3, A{0});
+    am.insert(2, B{0});
+    am.insert(3, B{0});
+    am.insert(4, B{0});
+    am.insert(5, B{0});
+    am.insert(0, C{0});
+    am.insert(2, C{0});
+    am.insert(4, C{0});
+    am.insert(6, C{0});
+
+    REQUIRE(toSet(am.view<A>()) == std::set<size_t>{0, 1, 2, 3});
+    REQUIRE(toSet(am.view<B>()) == std::set<size_t>{2, 3, 4, 5});
+    REQUIRE(toSet(am.view<C>()) == std::set<size_t>{0, 2, 4, 6});
+    REQUIRE(toSet(am.view<A, B>()) == std::set<size_t>{2, 3});
+    REQUIRE(toSet(am.view<B, A>()) == std::set<size_t>{2, 3});
+    REQUIRE(toSet(am.view<B, C>()) == std::set<size_t>{2, 4});
+    REQUIRE(toSet(am.view<A, C>()) == std::set<size_t>{0, 2});
+    REQUIRE(toSet(am.view<A, B, C>()) == std::set<size_t>{2});
+    REQUIRE(toSet(am.view<C, A, B>()) == std::set<size_t>{2});
+}
+
+
+TEST_CASE("ArchetypeManager - each", "[unit][ecs]") {
+    ArchetypeManager am;
+    am.insert(0, A{0});
+    am.insert(1, A{10});
+    am.insert(2, A{20});
+    am.insert(1, B{11});
+    am.insert(2, B{21});
+    am.insert(2, C{22});
+    am.insert(3, B{31});
+
+    std::map<size_t, std::pair<int, int>> pairs;
+    am.each<B, A>([&](size_t index, B& b, A& a) {
+        pairs[index] = {a.value, b.value};
+        a.value += 1;
+    });
+    REQUIRE(pairs == std::map<size_t, std::pair<int, int>>{
+        {1, {10, 11}}, {2, {20, 21}}});
+    REQUIRE(am.get<A>(1) == A{11});
+    REQUIRE(am.get<A>(2) == A{21});
+    REQUIRE(am.get<A>(0) == A{0});
+
+    int sum = 0;
+    am.each<const A, const B>([&sum](size_t, const A& a, const B& b) {
+        sum += a.value + b.value;
+    });
+    REQUIRE(sum == 11 + 11 + 21 + 21);
+    REQUIRE(toSet(am.view<const C>()) == std::set<size_t>{2});
+}
+
+
+TEST_CASE("ArchetypeManager - exclusion and optional terms", "[unit][ecs]") {
+    ArchetypeManager am;
+    am.insert(0, A{0});
+    am.insert(1, A{10});
+    am.insert(2, A{20});
+    am.insert(3, A{30});
+    am.insert(1, B{11});
+    am.insert(2, B{21});
+    am.insert(2, C{22});
+    am.insert(3, C{32});
+
+    REQUIRE(toSet(am.view<A, Without<B>>()) == std::set<size_t>{0, 3});
+    REQUIRE(toSet(am.view<A, Without<B, C>>()) == std::set<size_t>{0});
+    REQUIRE(toSet(am.view<A, B, Without<C>>()) == std::set<size_t>{1});
+    REQUIRE(toSet(am.view<A, Optional<B>>()) == std::set<size_t>{0, 1, 2, 3});
+
+    std::map<size_t, int> optional;
+    am.each<A, Optional<B>, Without<C>>([&](size_t index, A& a, B* b) {
+        optional[index] = b ? b->value : -a.value;
+    });
+    REQUIRE(optional == std::map<size_t, int>{{0, 0}, {1, 11}});
+}
+
+
+namespace {
+
+class Tracked {
+public:
+    Tracked(std::string& status) : status_(&status) {
+        *status_ = "valid";
+    }
+
+    ~Tracked() {
+        if (status_) {
+            *status_ = "destroyed";
+        }
+    }
+
+    Tracked(const Tracked&) = delete;
+    Tracked& operator=(const Tracked&) = delete;
+
+    Tracked(Tracked&& other) : status_(other.status_) {
+        other.status_ = nullptr;
+    }
+
+    Tracked& operator=(Tracked&& other) {
+        if (this != &other) {
+            if (status_) {
+                *status_ = "destroyed";
+            }
+            status_ = other.status_;
+            other.status_ = nullptr;
+        }
+        return *this;
+    }
+
+private:
+    std::string* status_ = nullptr;
+};
+
+}  // namespace
+
+TEST_CASE("ArchetypeManager - component lifecycle", "[unit][ecs]") {
+    std::string s0;
+    std::string s1;
+
+    {
+        ArchetypeManager am;
+        am.insert(0, Tracked(s0));
+        am.insert(1, Tracked(s1));
+        REQUIRE(s0 == "valid");
+        REQUIRE(s1 == "valid");
+
+        SECTION("none") {}
+
+        SECTION("move between archetypes") {
+            am.insert(0, A{100});
+            am.insert(1, B{201});
+            REQUIRE(s0 == "valid");
+            REQUIRE(s1 == "valid");
+            am.remove<A>(0);
+            REQUIRE(s0 == "valid");
+        }
+
+        SECTION("remove") {
+            am.insert(0, A{100});
+            am.remove<Tracked>(0);
+            REQUIRE(s0 == "destroyed");
+            REQUIRE(s1 == "valid");
+        }
+
+        SECTION("remove all") {
+            am.insert(0, A{100});
+            am.removeAll<Tracked>();
+            REQUIRE(s0 == "destroyed");
+            REQUIRE(s1 == "destroyed");
+            REQUIRE(am.get<A>(0) == A{100});
+        }
+    }
+
+    REQUIRE(s0 == "destroyed");
+    REQUIRE(s1 == "destroyed");
+}
+
+
+TEST_CASE("ArchetypeECSManager - components", "[unit][ecs]") {
+    using EntitySet = std::unordered_set<Entity, Entity::Hasher>;
+    ArchetypeECSManager ecs;
+    Entity a = ecs.createEntity();
+    Entity b = ecs.createEntity();
+    Entity c = ecs.createEntity();
+    ecs.insert(a, A{100});
+    ecs.insert(a, B{101});
+    ecs.insert(b, A{200});
+    ecs.insert(c, B{301});
+
+    REQUIRE(ecs.count<A>() == 2);
+    REQUIRE(ecs.count<B>() == 2);
+    REQUIRE(ecs.get<A>(a) == A{100});
+    REQUIRE(ecs.get<B>(c) == B{301});
+
+    auto ab = ecs.view<A, B>();
+    REQUIRE(EntitySet(ab.begin(), ab.end()) == EntitySet{a});
+
+    ecs.removeEntity(a);
+    REQUIRE(ecs.count<A>() == 1);
+    REQUIRE(ecs.count<B>() == 1);
+    REQUIRE(ecs.get<A>(b) == A{200});
+    auto bs = ecs.view<B>();
+    REQUIRE(EntitySet(bs.begin(), bs.end()) == EntitySet{c});
+}
+
+
+TEST_CASE("ArchetypeECSManager - bulk insertion", "[unit][ecs]") {
+    ArchetypeECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(5);
+    ecs.insert(e[0], A{0});
+    ecs.insert(e[1], B{1});
+    ecs.insert(e[2], B{2});
+
+    REQUIRE(ecs.insert(
+        std::vector{e[0], e[1], e[2], e[3], e[1]},
+        std::vector{A{10}, A{11}, A{12}, A{13}, A{21}}));
+    REQUIRE(!ecs.insert(std::vector{e[4]}, std::vector<A>{}));
+    REQUIRE(ecs.count<A>() == 4);
+    REQUIRE(ecs.get<A>(e[0]) == A{10});
+    REQUIRE(ecs.get<A>(e[1]) == A{21});
+    REQUIRE(ecs.get<A>(e[3]) == A{13});
+    REQUIRE(ecs.get<B>(e[2]) == B{2});
+    auto ab = ecs.view<A, B>();
+    REQUIRE(std::unordered_set<Entity, Entity::Hasher>(ab.begin(), ab.end())
+        == std::unordered_set<Entity, Entity::Hasher>{e[1], e[2]});
+}
+
+
+TEST_CASE("ArchetypeECSManager - parallel each", "[unit][ecs]") {
+    ArchetypeECSManager ecs;
+    ecs.setWorkerCount(3);
+    std::vector<Entity> entities;
+    for (int i = 0; i < 1000; ++i) {
+        Entity entity = ecs.createEntity();
+        entities.push_back(entity);
+        ecs.insert(entity, A{i});
+        if (i % 2 == 0) {
+            ecs.insert(entity, B{i});
+        }
+    }
+
+    ecs.parallelEach<A, Without<B>>([](Entity, A& a) { a.value = -1; }, 10);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(ecs.get<A>(entities[i]) == A{i % 2 == 0 ? i : -1});
+    }
+}
@@ -0,0 +1,150 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#include "istok/ecs/command_buffer.hpp"
+
+#include <catch.hpp>
+
+#include <unordered_set>
+#include <vector>
+
+#include "istok/ecs.hpp"
+
+using namespace Istok::ECS;
+
+
+namespace {
+
+struct A {
+    int value;
+    bool operator==(const A&) const = default;
+};
+
+struct B {
+    int value;
+    bool operator==(const B&) const = default;
+};
+
+}  // namespace
+
+
+TEMPLATE_TEST_CASE(
+    "CommandBuffer - operations", "[unit][ecs]",
+    ECSManager, ArchetypeECSManager
+) {
+    using EntitySet = std::unordered_set<Entity, Entity::Hasher>;
+    TestType ecs;
+    BasicCommandBuffer<TestType> commands;
+    REQUIRE(commands.empty());
+
+    Entity a = ecs.createEntity();
+    Entity b = ecs.createEntity();
+    Entity c = ecs.createEntity();
+    ecs.insert(a, A{100});
+    ecs.insert(b, A{200});
+    ecs.insert(b, B{201});
+    ecs.insert(c, B{301});
+
+    SECTION("insert") {
+        commands.insert(c, A{300});
+        commands.insert(a, B{101});
+        commands.insert(a, A{102});
+        commands.insert(a, A{103});
+        REQUIRE(!commands.empty());
+        REQUIRE(!ecs.template has<A>(c));
+        REQUIRE(commands.apply(ecs).empty());
+        REQUIRE(commands.empty());
+        REQUIRE(ecs.template get<A>(a) == A{103});
+        REQUIRE(ecs.template get<B>(a) == B{101});
+        REQUIRE(ecs.template get<A>(c) == A{300});
+    }
+
+    SECTION("create") {
+        auto x = commands.createEntity();
+        auto y = commands.createEntity();
+        commands.insert(y, A{1});
+        commands.insert(x, B{2});
+        auto created = commands.apply(ecs);
+        REQUIRE(created.size() == 2);
+        REQUIRE(ecs.isValidEntity(created[0]));
+        REQUIRE(ecs.isValidEntity(created[1]));
+        REQUIRE(ecs.template get<B>(created[0]) == B{2});
+        REQUIRE(ecs.template get<A>(created[1]) == A{1});
+        REQUIRE(!ecs.template has<A>(created[0]));
+    }
+
+    SECTION("remove") {
+        commands.template remove<A>(a);
+        commands.template remove<A>(a);
+        commands.template remove<A>(c);
+        commands.template remove<B>(b);
+        commands.apply(ecs);
+        REQUIRE(!ecs.template has<A>(a));
+        REQUIRE(!ecs.template has<B>(b));
+        REQUIRE(ecs.template get<A>(b) == A{200});
+        REQUIRE(ecs.template get<B>(c) == B{301});
+    }
+
+    SECTION("recording order") {
+        commands.insert(c, A{300});
+        commands.template removeAll<A>();
+        commands.insert(b, A{202});
+        commands.insert(a, B{101});
+        commands.template remove<B>(a);
+        commands.template remove<B>(c);
+        commands.insert(c, B{302});
+        commands.apply(ecs);
+        auto as = ecs.template view<A>();
+        REQUIRE(EntitySet(as.begin(), as.end()) == EntitySet{b});
+        REQUIRE(ecs.template get<A>(b) == A{202});
+        REQUIRE(!ecs.template has<B>(a));
+        REQUIRE(ecs.template get<B>(c) == B{302});
+    }
+
+    SECTION("removed target") {
+        commands.insert(a, B{101});
+        commands.template remove<A>(a);
+        ecs.removeEntity(a);
+        commands.apply(ecs);
+        REQUIRE(ecs.template count<A>() == 1);
+        REQUIRE(ecs.template count<B>() == 2);
+    }
+
+    SECTION("remove entity") {
+        commands.insert(b, A{202});
+        commands.removeEntity(b);
+        commands.removeEntity(b);
+        commands.apply(ecs);
+        REQUIRE(!ecs.isValidEntity(b));
+        REQUIRE(ecs.template count<A>() == 1);
+        REQUIRE(ecs.template count<B>() == 1);
+    }
+}
+
+
+TEST_CASE("CommandBuffer - record during iteration", "[unit][ecs]") {
+    ECSManager ecs;
+    ecs.setWorkerCount(GENERATE(0, 3));
+    std::vector<Entity> entities;
+    for (int i = 0; i < 1000; ++i) {
+        Entity entity = ecs.createEntity();
+        entities.push_back(entity);
+        ecs.insert(entity, A{i});
+    }
+
+    CommandBuffer commands;
+    ecs.parallelEach<A>(
+        [&commands](Entity entity, A& a) {
+            if (a.value % 2 == 0) {
+                commands.insert(entity, B{a.value});
+            } else {
+                commands.remove<A>(entity);
+            }
+        }, 10);
+    commands.apply(ecs);
+
+    REQUIRE(ecs.count<A>() == 500);
+    REQUIRE(ecs.count<B>() == 500);
+    for (int i = 0; i < 1000; i += 2) {
+        REQUIRE(ecs.get<A>(entities[i]) == A{i});
+        REQUIRE(ecs.get<B>(entities[i]) == B{i});
+    }
+}
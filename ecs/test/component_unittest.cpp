@@ -3,7 +3,11 @@
 
 #include <catch.hpp>
 
+#include <algorithm>
+#include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 using namespace Istok::ECS::Internal;
 
@@ -17,6 +21,32 @@ std::set<size_t> indexSet(ComponentStorage<T>& storage) {
 
 }  // namespace
 
+TEST_CASE("SparseIndex - basics", "[unit][ecs]") {
+    SparseIndex si;
+    REQUIRE(si.get(0) == SparseIndex::kEmpty);
+    REQUIRE(si.get(1'000'000) == SparseIndex::kEmpty);
+
+    const size_t far = SparseIndex::kPageSize * 100 + 5;
+    si.set(3, 30);
+    si.set(far, 50);
+    REQUIRE(si.get(3) == 30);
+    REQUIRE(si.get(far) == 50);
+    REQUIRE(si.get(2) == SparseIndex::kEmpty);
+    REQUIRE(si.get(SparseIndex::kPageSize * 50) == SparseIndex::kEmpty);
+    REQUIRE(si.get(far - 1) == SparseIndex::kEmpty);
+
+    si.reset(3);
+    REQUIRE(si.get(3) == SparseIndex::kEmpty);
+    REQUIRE(si.get(far) == 50);
+
+    SparseIndex moved(std::move(si));
+    REQUIRE(moved.get(far) == 50);
+
+    moved.clear();
+    REQUIRE(moved.get(far) == SparseIndex::kEmpty);
+}
+
+
 TEST_CASE("ComponentStorage - basics", "[unit][ecs]") {
     ComponentStorage<int> cs;
     REQUIRE(cs.size() == 0);
@@ -101,6 +131,21 @@ TEST_CASE("ComponentStorage - basics", "[unit][ecs]") {
 }
 
 
+TEST_CASE("ComponentStorage - high indices", "[unit][ecs]") {
+    ComponentStorage<int> cs;
+    cs.insert(10'000'000, 42);
+    cs.insert(5, 5);
+    REQUIRE(cs.size() == 2);
+    REQUIRE(cs.has(10'000'000));
+    REQUIRE(!cs.has(9'999'999));
+    REQUIRE(!cs.has(20'000'000));
+    REQUIRE(cs.get(10'000'000) == 42);
+    cs.remove(5);
+    REQUIRE(cs.get(10'000'000) == 42);
+    REQUIRE(indexSet(cs) == std::set<size_t>{10'000'000});
+}
+
+
 TEST_CASE("ComponentStorage - removeIfHas", "[unit][ecs]") {
     ComponentStorage<int> cs;
     cs.insert(0, 40);
@@ -257,6 +302,16 @@ namespace {
 }  // namespace
 
 
+TEST_CASE("typeId", "[unit][ecs]") {
+    REQUIRE(typeId<A>() == typeId<A>());
+    REQUIRE(typeId<A>() == typeId<const A>());
+    REQUIRE(typeId<A>() == typeId<A&>());
+    REQUIRE(typeId<A>() != typeId<B>());
+    REQUIRE(typeId<B>() != typeId<C>());
+    REQUIRE(typeId<C>() != typeId<A>());
+}
+
+
 TEST_CASE("ComponentManager - basic", "[unit][ecs]") {
     ComponentManager cm;
     REQUIRE(cm.count<A>() == 0);
@@ -426,6 +481,23 @@ TEST_CASE("ComponentManager - view", "[unit][ecs]") {
     REQUIRE(toSet(cm.view<C, A, B>()) == std::set<size_t>{2});
 }
 
+TEST_CASE("ComponentManager - view driver", "[unit][ecs]") {
+    ComponentManager cm;
+    for (size_t i = 0; i < 10; ++i) {
+        cm.insert(i, A{0});
+    }
+    cm.insert(7, B{0});
+    cm.insert(3, B{0});
+    cm.insert(11, B{0});
+
+    auto ab = cm.view<A, B>();
+    REQUIRE(std::vector<size_t>(ab.begin(), ab.end())
+        == std::vector<size_t>{7, 3});
+    auto ba = cm.view<B, A>();
+    REQUIRE(std::vector<size_t>(ba.begin(), ba.end())
+        == std::vector<size_t>{7, 3});
+}
+
 TEST_CASE("ComponentManager - empty view", "[unit][ecs]") {
     ComponentManager cm;
 
@@ -438,3 +510,560 @@ TEST_CASE("ComponentManager - empty view", "[unit][ecs]") {
 
     REQUIRE(toSet(cm.view<A, B>()) == std::set<size_t>{});
 }
+
+
+TEST_CASE("ComponentManager - each", "[unit][ecs]") {
+    ComponentManager cm;
+    cm.insert(0, A{0});
+    cm.insert(1, A{10});
+    cm.insert(2, A{20});
+    cm.insert(1, B{11});
+    cm.insert(2, B{21});
+    cm.insert(3, B{31});
+
+    std::map<size_t, int> single;
+    cm.each<A>([&](size_t index, A& a) { single[index] = a.value; });
+    REQUIRE(single == std::map<size_t, int>{{0, 0}, {1, 10}, {2, 20}});
+
+    std::map<size_t, std::pair<int, int>> pairs;
+    cm.each<B, A>([&](size_t index, B& b, A& a) {
+        pairs[index] = {a.value, b.value};
+        a.value += 1;
+    });
+    REQUIRE(pairs == std::map<size_t, std::pair<int, int>>{
+        {1, {10, 11}}, {2, {20, 21}}});
+    REQUIRE(cm.get<A>(1) == A{11});
+    REQUIRE(cm.get<A>(2) == A{21});
+    REQUIRE(cm.get<A>(0) == A{0});
+
+    size_t calls = 0;
+    cm.each<A, C>([&](size_t, A&, C&) { ++calls; });
+    REQUIRE(calls == 0);
+}
+
+
+TEST_CASE("ComponentManager - exclusion and optional terms", "[unit][ecs]") {
+    using Istok::ECS::Optional;
+    using Istok::ECS::Without;
+    ComponentManager cm;
+    cm.insert(0, A{0});
+    cm.insert(1, A{10});
+    cm.insert(2, A{20});
+    cm.insert(3, A{30});
+    cm.insert(1, B{11});
+    cm.insert(2, B{21});
+    cm.insert(2, C{22});
+    cm.insert(3, C{32});
+
+    REQUIRE(toSet(cm.view<A, Without<B>>()) == std::set<size_t>{0, 3});
+    REQUIRE(toSet(cm.view<Without<B>, A>()) == std::set<size_t>{0, 3});
+    REQUIRE(toSet(cm.view<A, Without<B, C>>()) == std::set<size_t>{0});
+    REQUIRE(toSet(cm.view<A, Without<B>, Without<C>>())
+        == std::set<size_t>{0});
+    REQUIRE(toSet(cm.view<A, B, Without<C>>()) == std::set<size_t>{1});
+    REQUIRE(toSet(cm.view<A, Optional<B>>()) == std::set<size_t>{0, 1, 2, 3});
+
+    std::map<size_t, int> optional;
+    cm.each<A, Optional<B>, Without<C>>([&](size_t index, A& a, B* b) {
+        optional[index] = b ? b->value : -a.value;
+    });
+    REQUIRE(optional == std::map<size_t, int>{{0, 0}, {1, 11}});
+}
+
+
+TEST_CASE("ComponentStorage - ticks", "[unit][ecs]") {
+    ComponentStorage<A> storage;
+    storage.insert(0, A{0});
+    storage.insert(1, A{10});
+    REQUIRE(storage.addedTick(0) == 1);
+    REQUIRE(storage.changedTick(1) == 1);
+
+    storage.setTick(2);
+    std::as_const(storage).get(0);
+    REQUIRE(storage.changedTick(0) == 1);
+    storage.get(0).value = 1;
+    REQUIRE(storage.addedTick(0) == 1);
+    REQUIRE(storage.changedTick(0) == 2);
+    REQUIRE(storage.changedTick(1) == 1);
+
+    storage.setTick(3);
+    storage.insert(2, A{20});
+    storage.insert(1, A{11});
+    REQUIRE(storage.addedTick(1) == 1);
+    REQUIRE(storage.changedTick(1) == 3);
+    storage.remove(0);
+    REQUIRE(storage.addedTick(2) == 3);
+    REQUIRE(storage.changedTick(2) == 3);
+
+    storage.setTick(4);
+    storage.components();
+    REQUIRE(storage.changedTick(1) == 4);
+    REQUIRE(storage.changedTick(2) == 4);
+}
+
+
+TEST_CASE("ComponentManager - change tracking terms", "[unit][ecs]") {
+    using Istok::ECS::Added;
+    using Istok::ECS::Changed;
+    using Istok::ECS::Tick;
+    ComponentManager cm;
+    cm.insert(0, A{0});
+    cm.insert(1, A{10});
+    cm.insert(1, B{11});
+    Tick first = cm.advanceTick();
+    REQUIRE(first == 1);
+    REQUIRE(cm.tick() == 2);
+
+    cm.insert(2, A{20});
+    cm.get<A>(0).value = 1;
+    cm.get<const A>(1);
+    cm.each<const A, B>([](size_t, const A&, B&) {});
+    REQUIRE(toSet(cm.view<Added<A>>(first)) == std::set<size_t>{2});
+    REQUIRE(toSet(cm.view<Changed<A>>(first)) == std::set<size_t>{0, 2});
+    REQUIRE(toSet(cm.view<Changed<B>>(first)) == std::set<size_t>{1});
+    REQUIRE(toSet(cm.view<Changed<A>>(0)) == std::set<size_t>{0, 1, 2});
+    REQUIRE(toSet(cm.view<Changed<A>, B>(first)) == std::set<size_t>{});
+
+    Tick second = cm.advanceTick();
+    REQUIRE(toSet(cm.view<Changed<A>>(second)) == std::set<size_t>{});
+    cm.each<A>([](size_t, A&) {});
+    std::map<size_t, int> changed;
+    cm.each<Changed<A>>(second, [&](size_t index, const A& a) {
+        changed[index] = a.value;
+    });
+    REQUIRE(changed == std::map<size_t, int>{{0, 1}, {1, 10}, {2, 20}});
+}
+
+
+TEST_CASE("ComponentManager - owning group", "[unit][ecs]") {
+    ComponentManager cm;
+    for (size_t i = 0; i < 10; ++i) {
+        cm.insert(i, A{int(i)});
+        if (i % 2 == 0) {
+            cm.insert(i, B{int(i)});
+        }
+    }
+    REQUIRE(cm.group<A, B>());
+    REQUIRE(cm.group<B, A>());
+    REQUIRE(!cm.group<A, C>());
+    REQUIRE(!cm.group<C, B>());
+    REQUIRE(cm.count<C>() == 0);
+
+    auto members = [&cm] {
+        std::map<size_t, std::pair<int, int>> result;
+        cm.each<B, A>([&](size_t index, B& b, A& a) {
+            result[index] = {a.value, b.value};
+        });
+        return result;
+    };
+    auto expected = [](std::set<size_t> indices) {
+        std::map<size_t, std::pair<int, int>> result;
+        for (size_t i : indices) {
+            result[i] = {int(i), int(i)};
+        }
+        return result;
+    };
+    REQUIRE(members() == expected({0, 2, 4, 6, 8}));
+
+    cm.insert(3, B{3});
+    cm.remove<A>(4);
+    cm.remove<B>(0);
+    cm.insert(11, B{11});
+    cm.insert(11, A{11});
+    REQUIRE(members() == expected({2, 3, 6, 8, 11}));
+    REQUIRE(toSet(cm.view<A, B>()) == std::set<size_t>{2, 3, 6, 8, 11});
+    REQUIRE(cm.get<A>(5) == A{5});
+    REQUIRE(cm.get<B>(3) == B{3});
+
+    cm.clearIndex(6);
+    REQUIRE(members() == expected({2, 3, 8, 11}));
+    cm.removeAll<B>();
+    REQUIRE(members().empty());
+    cm.insert(7, B{7});
+    REQUIRE(members() == expected({7}));
+}
+
+
+TEST_CASE("ComponentManager - sort", "[unit][ecs]") {
+    using Istok::ECS::Changed;
+    ComponentManager cm;
+    for (size_t i = 0; i < 100; ++i) {
+        cm.insert(i, A{int(i * 37 % 100)});
+        if (i % 3 == 0) {
+            cm.insert(i, B{int(i)});
+        }
+    }
+    for (size_t i = 0; i < 100; i += 7) {
+        cm.remove<A>(i);
+    }
+    auto values = [&cm] {
+        std::vector<int> result;
+        cm.each<const A>([&result](size_t, const A& a) {
+            result.push_back(a.value);
+        });
+        return result;
+    };
+    auto since = cm.advanceTick();
+
+    cm.sort<A>([](const A& a, const A& b) { return a.value < b.value; });
+    REQUIRE(std::ranges::is_sorted(values()));
+    REQUIRE(values().size() == 85);
+    for (size_t i = 1; i < 100; ++i) {
+        if (i % 7) {
+            REQUIRE(cm.get<const A>(i) == A{int(i * 37 % 100)});
+        }
+    }
+    REQUIRE(toSet(cm.view<Changed<A>>(since)).empty());
+
+    cm.sortAs<A, B>();
+    std::vector<size_t> expected;
+    for (size_t index : cm.view<B>()) {
+        if (cm.has<A>(index)) {
+            expected.push_back(index);
+        }
+    }
+    auto order = cm.view<A>();
+    REQUIRE(std::vector(order.begin(), order.begin() + expected.size())
+        == expected);
+    REQUIRE(toSet(cm.view<A, B>())
+        == std::set(expected.begin(), expected.end()));
+}
+
+
+TEST_CASE("ComponentManager - sort grouped", "[unit][ecs]") {
+    ComponentManager cm;
+    for (size_t i = 0; i < 10; ++i) {
+        cm.insert(i, A{int(10 - i)});
+        cm.insert(9 - i, C{int(i)});
+        if (i % 2 == 0) {
+            cm.insert(i, B{int(i)});
+        }
+    }
+    REQUIRE(cm.group<A, B>());
+    auto order = [&cm] {
+        auto indices = cm.view<A>();
+        return std::vector(indices.begin(), indices.end());
+    };
+    std::vector<size_t> grouped = order();
+
+    REQUIRE(!cm.sort<A>([](const A& a, const A& b) {
+        return a.value < b.value;
+    }));
+    REQUIRE(order() == grouped);
+    REQUIRE(!cm.sortAs<A, C>());
+    REQUIRE(order() == grouped);
+    std::vector<size_t> reversed(grouped.rbegin(), grouped.rend());
+    REQUIRE(!cm.sortAs<A>(reversed));
+    REQUIRE(order() == grouped);
+    std::map<size_t, int> members;
+    cm.each<A, B>([&members](size_t index, A& a, B& b) {
+        members[index] = a.value + b.value;
+    });
+    REQUIRE(members.size() == 5);
+    REQUIRE(members[4] == 10);
+
+    REQUIRE(cm.sortAs<C, A>());
+    auto sorted = cm.view<C>();
+    REQUIRE(std::vector(sorted.begin(), sorted.end()) == grouped);
+}
+
+
+namespace {
+    struct Stable {
+        int value;
+        bool operator==(const Stable&) const = default;
+    };
+}  // namespace
+
+template <>
+struct Istok::ECS::StableComponent<Stable> : std::true_type {};
+
+
+TEST_CASE("ComponentStorage - stable components", "[unit][ecs]") {
+    ComponentStorage<Stable> storage;
+    std::vector<const Stable*> addresses;
+    for (size_t i = 0; i < 3000; ++i) {
+        storage.insert(i, Stable{int(i)});
+        addresses.push_back(&storage.get(i));
+    }
+    for (size_t i = 0; i < 3000; i += 2) {
+        storage.remove(i);
+    }
+    const Stable* hole = addresses[2998];
+    storage.insert(5000, Stable{5000});
+    REQUIRE(&storage.get(5000) == hole);
+    storage.sort([](const Stable& a, const Stable& b) {
+        return a.value > b.value;
+    });
+    for (size_t i = 1; i < 3000; i += 2) {
+        REQUIRE(&storage.get(i) == addresses[i]);
+        REQUIRE(storage.get(i) == Stable{int(i)});
+    }
+    auto components = storage.components();
+    REQUIRE(components.size() == 1501);
+    REQUIRE(components[0] == Stable{5000});
+    REQUIRE(components[1] == Stable{2999});
+    REQUIRE(storage.indices()[1] == 2999);
+}
+
+
+namespace {
+    struct Throwing {
+        int value;
+
+        explicit Throwing(int value) : value(value) {}
+
+        Throwing(Throwing&& other) : value(other.value) {
+            if (value < 0) {
+                throw value;
+            }
+        }
+    };
+
+    struct Large {
+        char data[64 * 1024];
+    };
+}  // namespace
+
+static_assert(PagedComponents<Large>::kPageSize == 1);
+static_assert(PagedComponents<int>::kPageSize
+    == PagedComponents<int>::kPageBytes / sizeof(int));
+
+
+TEST_CASE("PagedComponents - failed construction", "[unit][ecs]") {
+    PagedComponents<Throwing> components;
+    components.push_back(Throwing(0));
+    components.push_back(Throwing(1));
+    const Throwing* next = &components[1] + 1;
+    REQUIRE_THROWS(components.push_back(Throwing(-1)));
+    REQUIRE(components.size() == 2);
+    components.push_back(Throwing(2));
+    REQUIRE(&components[2] == next);
+
+    const Throwing* hole = &components[0];
+    components.swapRemove(0);
+    REQUIRE_THROWS(components.push_back(Throwing(-1)));
+    components.push_back(Throwing(3));
+    REQUIRE(&components[2] == hole);
+    REQUIRE(components[2].value == 3);
+}
+
+
+TEST_CASE("ComponentManager - stable components", "[unit][ecs]") {
+    ComponentManager cm;
+    for (size_t i = 0; i < 10; ++i) {
+        cm.insert(i, Stable{int(i)});
+        if (i % 2 == 0) {
+            cm.insert(i, A{int(i)});
+        }
+    }
+    const Stable* address = &cm.get<const Stable>(8);
+    cm.group<Stable, A>();
+    cm.remove<Stable>(0);
+    REQUIRE(&cm.get<const Stable>(8) == address);
+    std::map<size_t, int> members;
+    cm.each<Stable, A>([&members](size_t index, Stable& stable, A& a) {
+        members[index] = stable.value + a.value;
+    });
+    REQUIRE(members
+        == std::map<size_t, int>{{2, 4}, {4, 8}, {6, 12}, {8, 16}});
+}
+
+
+TEST_CASE("ComponentManager - cached query", "[unit][ecs]") {
+    using Istok::ECS::Optional;
+    using Istok::ECS::Without;
+    ComponentManager cm;
+    for (size_t i = 0; i < 10; ++i) {
+        cm.insert(i, A{int(i)});
+        if (i % 2 == 0) {
+            cm.insert(i, B{int(i)});
+        }
+        if (i % 3 == 0) {
+            cm.insert(i, C{int(i)});
+        }
+    }
+    auto query = [&cm] {
+        return toSet(cm.query<A, Without<C>, Optional<B>>());
+    };
+    REQUIRE(query() == std::set<size_t>{1, 2, 4, 5, 7, 8});
+
+    cm.insert(10, A{10});
+    cm.insert(2, C{2});
+    cm.remove<C>(3);
+    cm.remove<A>(4);
+    cm.insert(5, B{5});
+    REQUIRE(query() == std::set<size_t>{1, 3, 5, 7, 8, 10});
+
+    cm.clearIndex(7);
+    cm.removeAll<C>();
+    REQUIRE(query() == std::set<size_t>{0, 1, 2, 3, 5, 6, 8, 9, 10});
+
+    std::map<size_t, int> visited;
+    cm.each<A, Without<C>, Optional<B>>(
+        [&visited](size_t index, A& a, B* b) {
+            visited[index] = a.value + (b ? b->value : 0);
+        });
+    REQUIRE(visited.size() == 9);
+    REQUIRE(visited[5] == 10);
+    REQUIRE(visited[9] == 9);
+
+    // Queries have their own ids and do not widen the signatures.
+    struct Marked { int value; };
+    struct Before {};
+    struct After {};
+    cm.insert(11, Marked{11});
+    size_t before = typeId<Before>();
+    REQUIRE(toSet(cm.query<Marked, Without<A>>()) == std::set<size_t>{11});
+    REQUIRE(typeId<After>() == before + 1);
+    cm.clearIndex(11);
+    REQUIRE(cm.query<Marked, Without<A>>().empty());
+}
+
+
+TEST_CASE("SignatureTable - basics", "[unit][ecs]") {
+    SignatureTable table;
+    REQUIRE(!table.test(0, 0));
+    table.set(2, 3);
+    table.set(2, 70);
+    table.set(5, 130);
+    REQUIRE(table.test(2, 3));
+    REQUIRE(table.test(2, 70));
+    REQUIRE(table.test(5, 130));
+    REQUIRE(!table.test(2, 130));
+    REQUIRE(!table.test(1, 3));
+    REQUIRE(!table.test(100, 3));
+
+    std::vector<size_t> ids;
+    table.forEach(2, [&ids](size_t id) { ids.push_back(id); });
+    REQUIRE(ids == std::vector<size_t>{3, 70});
+
+    SignatureMask mask;
+    mask.require(3);
+    mask.exclude(130);
+    REQUIRE(table.matches(2, mask));
+    REQUIRE(!table.matches(5, mask));
+    table.set(2, 130);
+    REQUIRE(!table.matches(2, mask));
+
+    table.reset(2, 3);
+    REQUIRE(!table.test(2, 3));
+    table.resetRow(2);
+    REQUIRE(!table.test(2, 70));
+    REQUIRE(table.test(5, 130));
+}
+
+
+namespace {
+
+template <int N>
+struct Tag {
+    int value;
+};
+
+template <int... Ns>
+void insertTags(ComponentManager& cm, size_t index) {
+    (cm.insert(index, Tag<Ns>{Ns}), ...);
+}
+
+}  // namespace
+
+TEST_CASE("ComponentManager - many component types", "[unit][ecs]") {
+    ComponentManager cm;
+    [&cm]<int... Ns>(std::integer_sequence<int, Ns...>) {
+        insertTags<Ns...>(cm, 0);
+        insertTags<Ns...>(cm, 1);
+    }(std::make_integer_sequence<int, 100>{});
+    cm.insert(1, A{1});
+    cm.insert(2, Tag<99>{99});
+
+    REQUIRE(cm.has<Tag<0>>(0));
+    REQUIRE(cm.has<Tag<99>>(1));
+    REQUIRE(!cm.has<A>(0));
+    REQUIRE(toSet(cm.view<Tag<99>, Tag<50>>()) == std::set<size_t>{0, 1});
+    REQUIRE(toSet(cm.view<Tag<99>, Istok::ECS::Without<A>>())
+        == std::set<size_t>{0, 2});
+
+    cm.clearIndex(1);
+    REQUIRE(!cm.has<Tag<0>>(1));
+    REQUIRE(!cm.has<A>(1));
+    REQUIRE(cm.count<Tag<99>>() == 2);
+    REQUIRE(cm.count<A>() == 0);
+    REQUIRE(cm.get<Tag<42>>(0).value == 42);
+
+    cm.removeAll<Tag<99>>();
+    REQUIRE(!cm.has<Tag<99>>(0));
+    REQUIRE(!cm.has<Tag<99>>(2));
+}
+
+
+namespace {
+
+struct Marker {};
+
+}  // namespace
+
+TEST_CASE("ComponentStorage - empty components", "[unit][ecs]") {
+    ComponentStorage<Marker> storage;
+    REQUIRE(storage.size() == 0);
+    REQUIRE(!storage.has(0));
+
+    storage.insert(5, Marker{});
+    storage.insert(1, Marker{});
+    storage.insert(200, Marker{});
+    storage.insert(1, Marker{});
+    REQUIRE(storage.size() == 3);
+    REQUIRE(storage.has(1));
+    REQUIRE(storage.has(200));
+    REQUIRE(!storage.has(2));
+    REQUIRE(storage.find(2) == nullptr);
+    REQUIRE(storage.find(5) != nullptr);
+    REQUIRE(indexSet(storage) == std::set<size_t>{1, 5, 200});
+
+    storage.remove(5);
+    REQUIRE(storage.size() == 2);
+    REQUIRE(!storage.has(5));
+    auto indices = storage.indices();
+    REQUIRE(std::vector<size_t>(indices.begin(), indices.end())
+        == std::vector<size_t>{1, 200});
+
+    storage.removeIfHas(5);
+    storage.removeIfHas(1);
+    storage.insert(7, Marker{});
+    REQUIRE(indexSet(storage) == std::set<size_t>{7, 200});
+
+    storage.clear();
+    REQUIRE(storage.size() == 0);
+    REQUIRE(!storage.has(200));
+    REQUIRE(storage.indices().empty());
+}
+
+
+TEST_CASE("ComponentManager - empty components", "[unit][ecs]") {
+    ComponentManager cm;
+    cm.insert(0, A{0});
+    cm.insert(1, A{10});
+    cm.insert(2, A{20});
+    cm.insert(1, Marker{});
+    cm.insert(2, Marker{});
+    cm.insert(3, Marker{});
+
+    REQUIRE(cm.count<Marker>() == 3);
+    REQUIRE(toSet(cm.view<Marker>()) == std::set<size_t>{1, 2, 3});
+    REQUIRE(toSet(cm.view<A, Marker>()) == std::set<size_t>{1, 2});
+    REQUIRE(toSet(cm.view<A, Istok::ECS::Without<Marker>>())
+        == std::set<size_t>{0});
+
+    std::set<size_t> visited;
+    cm.each<Marker>([&visited](size_t index, Marker&) {
+        visited.insert(index);
+    });
+    REQUIRE(visited == std::set<size_t>{1, 2, 3});
+
+    cm.remove<Marker>(2);
+    cm.clearIndex(3);
+    REQUIRE(toSet(cm.view<Marker>()) == std::set<size_t>{1});
+    cm.removeAll<Marker>();
+    REQUIRE(cm.count<Marker>() == 0);
+    REQUIRE(!cm.has<Marker>(1));
+}
@@ -1,7 +1,13 @@
 // Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
 #include "istok/ecs.hpp"
 
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <string>
 #include <unordered_set>
+#include <vector>
 
 #include <catch.hpp>
 #include <catch2/trompeloeil.hpp>
@@ -172,6 +178,185 @@ EntitySet toEntitySet(T x) {
 }  // namespace
 
 
+TEST_CASE("ECSManager - bulk operations", "[unit][ecs]") {
+    ECSManager ecs;
+    Entity first = ecs.createEntity();
+    ecs.removeEntity(first);
+
+    std::vector<Entity> entities = ecs.createEntities(1000);
+    REQUIRE(entities.size() == 1000);
+    REQUIRE(std::unordered_set<Entity, Entity::Hasher>(
+        entities.begin(), entities.end()).size() == 1000);
+    for (Entity entity : entities) {
+        REQUIRE(ecs.isValidEntity(entity));
+    }
+
+    std::vector<A> as;
+    for (int i = 0; i < 1000; ++i) {
+        as.push_back(A{i});
+    }
+    REQUIRE(ecs.insert(entities, as));
+    REQUIRE(ecs.insert(
+        entities | std::views::take(10),
+        std::views::iota(0, 10)
+            | std::views::transform([](int i) { return B{i}; })));
+    std::vector<std::unique_ptr<int>> pointers;
+    pointers.push_back(std::make_unique<int>(7));
+    REQUIRE(ecs.insert(
+        entities | std::views::drop(999), std::move(pointers)));
+    REQUIRE(!ecs.insert(entities | std::views::take(3), std::vector{C{}}));
+    REQUIRE(ecs.count<C>() == 0);
+
+    REQUIRE(ecs.count<A>() == 1000);
+    REQUIRE(ecs.count<B>() == 10);
+    REQUIRE(ecs.get<A>(entities[500]) == A{500});
+    REQUIRE(ecs.get<B>(entities[9]) == B{9});
+    REQUIRE(*ecs.get<std::unique_ptr<int>>(entities[999]) == 7);
+
+    ecs.removeEntities(entities | std::views::drop(5));
+    REQUIRE(ecs.count<A>() == 5);
+    REQUIRE(ecs.count<B>() == 5);
+    REQUIRE(ecs.count<std::unique_ptr<int>>() == 0);
+    REQUIRE(ecs.isValidEntity(entities[4]));
+    REQUIRE(!ecs.isValidEntity(entities[5]));
+}
+
+
+TEST_CASE("ECSManager - bulk insertion into a batch", "[unit][ecs]") {
+    ECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(4);
+    ecs.insert(e[0], A{100});
+    ecs.insert(e[3], B{300});
+    REQUIRE(ecs.group<A, B>());
+    std::vector<Entity> constructed;
+    std::vector<Entity> updated;
+    ecs.onConstruct<A>([&constructed](Entity entity) {
+        constructed.push_back(entity);
+    });
+    ecs.onUpdate<A>([&updated](Entity entity) {
+        updated.push_back(entity);
+    });
+    REQUIRE(std::ranges::distance(ecs.view<A>()) == 1);
+
+    REQUIRE(ecs.insert(
+        std::vector{e[1], e[0], e[3], e[1]},
+        std::vector{A{1}, A{0}, A{3}, A{11}}));
+    REQUIRE(ecs.count<A>() == 3);
+    REQUIRE(ecs.get<const A>(e[0]) == A{0});
+    REQUIRE(ecs.get<const A>(e[1]) == A{11});
+    REQUIRE(ecs.get<const A>(e[3]) == A{3});
+    REQUIRE(constructed == std::vector{e[1], e[3]});
+    REQUIRE(updated == std::vector{e[0]});
+    REQUIRE(std::ranges::distance(ecs.view<A>()) == 3);
+    REQUIRE(std::ranges::distance(ecs.view<A, B>()) == 1);
+    ecs.each<const A, const B>([&](Entity entity, const A& a, const B&) {
+        REQUIRE(entity == e[3]);
+        REQUIRE(a == A{3});
+    });
+}
+
+
+namespace {
+
+struct Tag {};
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocated = 0;
+
+private:
+    std::pmr::monotonic_buffer_resource arena_{
+        std::pmr::new_delete_resource()};
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocated += bytes;
+        return arena_.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other
+    ) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Fails any allocation that falls back to the default resource.
+struct NullDefaultResource {
+    std::pmr::memory_resource* previous =
+        std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    ~NullDefaultResource() {
+        std::pmr::set_default_resource(previous);
+    }
+};
+
+}  // namespace
+
+
+TEMPLATE_TEST_CASE(
+    "ECSManager - backend parity", "[unit][ecs]",
+    ECSManager, ArchetypeECSManager
+) {
+    TestType ecs;
+    Entity entity = ecs.createEntity();
+    ecs.insert(entity, A{1});
+    ecs.insert(entity, B{2});
+    REQUIRE(ecs.template get<const A>(entity) == A{1});
+    REQUIRE(&ecs.template get<const A>(entity)
+        == &ecs.template get<A>(entity));
+    ecs.template get<B>(entity).value = 3;
+    REQUIRE(ecs.template get<const B>(entity) == B{3});
+    int sum = 0;
+    ecs.template each<const A, const B>(
+        [&sum](Entity, const A& a, const B& b) { sum += a.value + b.value; });
+    REQUIRE(sum == 4);
+}
+
+
+TEMPLATE_TEST_CASE(
+    "ECSManager - memory resource", "[unit][ecs]",
+    ECSManager, ArchetypeECSManager
+) {
+    CountingResource resource;
+    NullDefaultResource guard;
+    {
+        TestType ecs(&resource);
+        std::vector<Entity> entities = ecs.createEntities(3000);
+        for (int i = 0; i < 3000; ++i) {
+            ecs.insert(entities[i], A{i});
+            if (i % 3 == 0) {
+                ecs.insert(entities[i], B{i});
+                ecs.insert(entities[i], Tag{});
+            }
+        }
+        REQUIRE(resource.allocated > 3000 * sizeof(A));
+
+        int sum = 0;
+        ecs.template each<A, B, Tag>(
+            [&sum](Entity, A& a, B&, Tag&) { sum += a.value; });
+        REQUIRE(sum == 999 * 1000 / 2 * 3);
+
+        ecs.removeEntities(entities | std::views::drop(1000));
+        ecs.template removeAll<Tag>();
+        REQUIRE(ecs.template count<A>() == 1000);
+        REQUIRE(ecs.template count<B>() == 334);
+        REQUIRE(ecs.template get<A>(entities[999]) == A{999});
+
+        if constexpr (std::is_same_v<TestType, ECSManager>) {
+            size_t allocated = resource.allocated;
+            auto query = ecs.template query<A, B>();
+            REQUIRE(std::ranges::distance(query) == 334);
+            REQUIRE(ecs.template sort<A>([](const A& a, const A& b) {
+                return a.value > b.value;
+            }));
+            REQUIRE(resource.allocated > allocated + 1000 * sizeof(size_t));
+        }
+    }
+}
+
+
 TEST_CASE("ECSManager - view", "[unit][ecs]") {
     ECSManager ecs;
     auto e0 = ecs.createEntity();
@@ -226,6 +411,281 @@ TEST_CASE("ECSManager - empty view", "[unit][ecs]") {
 }
 
 
+TEST_CASE("ECSManager - each", "[unit][ecs]") {
+    ECSManager ecs;
+    auto e0 = ecs.createEntity();
+    auto e1 = ecs.createEntity();
+    auto e2 = ecs.createEntity();
+    ecs.insert(e0, A{0});
+    ecs.insert(e1, A{10});
+    ecs.insert(e1, B{11});
+    ecs.insert(e2, B{21});
+
+    EntitySet visited;
+    ecs.each<A, B>([&](Entity entity, A& a, B& b) {
+        visited.insert(entity);
+        a.value = b.value;
+    });
+    REQUIRE(visited == EntitySet{e1});
+    REQUIRE(ecs.get<A>(e1) == A{11});
+
+    visited.clear();
+    ecs.each<B>([&](Entity entity, B&) { visited.insert(entity); });
+    REQUIRE(visited == EntitySet{e1, e2});
+}
+
+
+TEST_CASE("ECSManager - exclusion and optional terms", "[unit][ecs]") {
+    ECSManager ecs;
+    auto e0 = ecs.createEntity();
+    auto e1 = ecs.createEntity();
+    auto e2 = ecs.createEntity();
+    ecs.insert(e0, A{0});
+    ecs.insert(e1, A{10});
+    ecs.insert(e1, B{11});
+    ecs.insert(e2, A{20});
+    ecs.insert(e2, C{22});
+
+    REQUIRE(toEntitySet(ecs.view<A, Without<B>>()) == EntitySet{e0, e2});
+    REQUIRE(toEntitySet(ecs.view<A, Without<B, C>>()) == EntitySet{e0});
+
+    EntitySet withB;
+    EntitySet withoutB;
+    ecs.each<A, Optional<B>, Without<C>>([&](Entity entity, A&, B* b) {
+        (b ? withB : withoutB).insert(entity);
+    });
+    REQUIRE(withB == EntitySet{e1});
+    REQUIRE(withoutB == EntitySet{e0});
+}
+
+
+TEST_CASE("ECSManager - change tracking", "[unit][ecs]") {
+    using EntitySet = std::unordered_set<Entity, Entity::Hasher>;
+    ECSManager ecs;
+    Entity a = ecs.createEntity();
+    Entity b = ecs.createEntity();
+    ecs.insert(a, A{100});
+    ecs.insert(b, A{200});
+    Tick since = ecs.advanceTick();
+
+    ecs.get<A>(b).value += 1;
+    REQUIRE(ecs.get<const A>(a) == A{100});
+    auto changed = ecs.view<Changed<A>>(since);
+    REQUIRE(EntitySet(changed.begin(), changed.end()) == EntitySet{b});
+
+    since = ecs.advanceTick();
+    Entity c = ecs.createEntity();
+    ecs.insert(c, A{300});
+    std::vector<Entity> added;
+    ecs.each<Added<A>>(since, [&](Entity entity, const A&) {
+        added.push_back(entity);
+    });
+    REQUIRE(added == std::vector<Entity>{c});
+
+    // Read-only passes keep the changes, mutable ones stamp everything.
+    since = ecs.advanceTick();
+    ecs.each<const A>([](Entity, const A&) {});
+    REQUIRE(ecs.view<Changed<A>>(since).empty());
+    ecs.each<A>([](Entity, A&) {});
+    changed = ecs.view<Changed<A>>(since);
+    REQUIRE(EntitySet(changed.begin(), changed.end()) == EntitySet{a, b, c});
+}
+
+
+TEST_CASE("ECSManager - owning group", "[unit][ecs]") {
+    ECSManager ecs;
+    ecs.group<A, B>();
+    std::vector<Entity> entities;
+    for (int i = 0; i < 100; ++i) {
+        Entity entity = ecs.createEntity();
+        entities.push_back(entity);
+        ecs.insert(entity, A{i});
+        if (i % 3 == 0) {
+            ecs.insert(entity, B{i});
+        }
+    }
+    for (int i = 0; i < 100; i += 2) {
+        ecs.removeEntity(entities[i]);
+    }
+
+    int sum = 0;
+    ecs.each<A, B>([&sum](Entity, A& a, B& b) { sum += a.value + b.value; });
+    int expected = 0;
+    for (int i = 3; i < 100; i += 6) {
+        expected += 2 * i;
+    }
+    REQUIRE(sum == expected);
+}
+
+
+TEST_CASE("ECSManager - move assignment over a group", "[unit][ecs]") {
+    ECSManager ecs;
+    REQUIRE(ecs.group<A, B>());
+    for (int i = 0; i < 10; ++i) {
+        Entity entity = ecs.createEntity();
+        ecs.insert(entity, A{i});
+        ecs.insert(entity, B{i});
+    }
+    ECSManager other;
+    Entity entity = other.createEntity();
+    other.insert(entity, A{1});
+    other.insert(entity, B{2});
+    REQUIRE(other.group<A, B>());
+
+    ecs = std::move(other);
+    int sum = 0;
+    ecs.each<const A, const B>([&sum](Entity, const A& a, const B& b) {
+        sum += a.value + b.value;
+    });
+    REQUIRE(sum == 3);
+    REQUIRE(!ecs.group<A, C>());
+}
+
+
+TEST_CASE("ECSManager - lifecycle signals", "[unit][ecs]") {
+    ECSManager ecs;
+    std::vector<std::pair<std::string, Entity>> events;
+    ecs.onConstruct<A>([&](Entity entity) {
+        REQUIRE(ecs.has<A>(entity));
+        events.emplace_back("construct", entity);
+    });
+    ecs.onUpdate<A>([&](Entity entity) {
+        events.emplace_back("update", entity);
+    });
+    ecs.onDestroy<A>([&](Entity entity) {
+        REQUIRE(ecs.has<A>(entity));
+        events.emplace_back("destroy", entity);
+    });
+
+    Entity a = ecs.createEntity();
+    Entity b = ecs.createEntity();
+    Entity c = ecs.createEntity();
+    ecs.insert(a, A{1});
+    ecs.insert(b, A{2});
+    ecs.insert(c, A{3});
+    ecs.insert(c, B{3});
+    ecs.insert(a, A{10});
+    ecs.patch<A>(b, [](A& value) { value.value += 1; });
+    ecs.remove<A>(a);
+    ecs.removeEntity(b);
+    ecs.removeAll<B>();
+    ecs.removeAll<A>();
+
+    REQUIRE(!ecs.has<B>(c));
+    using Events = std::vector<std::pair<std::string, Entity>>;
+    REQUIRE(events == Events{
+        {"construct", a}, {"construct", b}, {"construct", c},
+        {"update", a}, {"update", b},
+        {"destroy", a}, {"destroy", b}, {"destroy", c}});
+}
+
+
+TEST_CASE("ECSManager - signals after move", "[unit][ecs]") {
+    ECSManager source;
+    std::vector<std::pair<std::string, Entity>> events;
+    source.onConstruct<A>([&](Entity entity) {
+        events.emplace_back("construct", entity);
+    });
+    source.onDestroy<A>([&](Entity entity) {
+        events.emplace_back("destroy", entity);
+    });
+    Entity a = source.createEntity();
+    source.insert(a, A{1});
+
+    ECSManager moved = std::move(source);
+    Entity b = moved.createEntity();
+    moved.insert(b, A{2});
+    moved.removeEntity(a);
+    ECSManager assigned;
+    assigned = std::move(moved);
+    assigned.remove<A>(b);
+
+    using Events = std::vector<std::pair<std::string, Entity>>;
+    REQUIRE(events == Events{
+        {"construct", a}, {"construct", b}, {"destroy", a}, {"destroy", b}});
+}
+
+
+TEST_CASE("ECSManager - parallel each", "[unit][ecs]") {
+    ECSManager ecs;
+    ecs.setWorkerCount(GENERATE(0, 3));
+    std::vector<Entity> entities;
+    for (int i = 0; i < 10000; ++i) {
+        Entity entity = ecs.createEntity();
+        entities.push_back(entity);
+        ecs.insert(entity, A{i});
+        if (i % 2 == 0) {
+            ecs.insert(entity, B{i});
+        }
+        if (i % 3 == 0) {
+            ecs.insert(entity, C{i});
+        }
+    }
+
+    Tick since = ecs.advanceTick();
+    ecs.parallelEach<A>([](Entity, A& a) { a.value += 1; }, 100);
+    REQUIRE(std::ranges::distance(ecs.view<Changed<A>>(since)) == 10000);
+    ecs.parallelEach<B, Without<C>>(
+        [](Entity, B& b) { b.value = -b.value; }, 100);
+    std::atomic<int> visited = 0;
+    ecs.parallelEach<A, Optional<C>>(
+        [&visited](Entity, A&, C* c) {
+            if (c) {
+                ++visited;
+            }
+        }, 100);
+
+    REQUIRE(visited == 3334);
+    for (int i = 0; i < 10000; ++i) {
+        REQUIRE(ecs.get<A>(entities[i]) == A{i + 1});
+        if (i % 2 == 0) {
+            REQUIRE(ecs.get<B>(entities[i]) == B{i % 3 == 0 ? i : -i});
+        }
+    }
+}
+
+
+TEST_CASE("ECSManager - scheduled systems", "[unit][ecs]") {
+    ECSManager ecs;
+    ecs.setWorkerCount(GENERATE(0, 3));
+    std::vector<Entity> entities;
+    for (int i = 0; i < 1000; ++i) {
+        Entity entity = ecs.createEntity();
+        entities.push_back(entity);
+        ecs.insert(entity, A{i});
+        ecs.insert(entity, B{0});
+    }
+
+    // B is derived from A, C only counts the frames.
+    // The readers of A run concurrently.
+    ecs.addLoopSystem<Write<A>>([&ecs]() noexcept {
+        ecs.each<A>([](Entity, A& a) { a.value += 1; });
+    });
+    ecs.addLoopSystem<Read<A>, Write<B>>([&ecs]() noexcept {
+        ecs.each<const A, B>([](Entity, const A& a, B& b) {
+            b.value = 2 * a.value;
+        });
+    });
+    int sum = 0;
+    ecs.addLoopSystem<Read<A>>([&ecs, &sum]() noexcept {
+        ecs.each<const A>([&sum](Entity, const A& a) { sum += a.value; });
+    });
+    int frames = 0;
+    ecs.addLoopSystem<Write<C>>([&frames]() noexcept { ++frames; });
+
+    ecs.iterate();
+    ecs.iterate();
+    REQUIRE(frames == 2);
+    // Both frames: the sum of i + 1 and of i + 2 over i < 1000.
+    REQUIRE(sum == 2 * 999 * 1000 / 2 + 3 * 1000);
+    REQUIRE(ecs.count<C>() == 0);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(ecs.get<A>(entities[i]) == A{i + 2});
+        REQUIRE(ecs.get<B>(entities[i]) == B{2 * (i + 2)});
+    }
+}
+
+
 TEST_CASE("ECSManager - component lifecycle", "[unit][ecs]") {
     MockValue ca, cb;
     auto ecs = std::make_unique<ECSManager>();
@@ -0,0 +1,196 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#include "istok/ecs/hierarchy.hpp"
+
+#include <catch.hpp>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "istok/ecs.hpp"
+
+using namespace Istok::ECS;
+
+
+namespace {
+
+struct Offset {
+    int value;
+};
+
+std::vector<Entity> children(ECSManager& ecs, Entity parent) {
+    std::vector<Entity> result;
+    ecs.eachChild(parent, [&result](Entity child) {
+        result.push_back(child);
+    });
+    return result;
+}
+
+// Terms handing out mutable links are rejected at compile time.
+static_assert(Internal::WritesNode<HierarchyNode>::value);
+static_assert(Internal::WritesNode<HierarchyNode&>::value);
+static_assert(Internal::WritesNode<Optional<HierarchyNode>>::value);
+static_assert(!Internal::WritesNode<const HierarchyNode>::value);
+static_assert(!Internal::WritesNode<Optional<const HierarchyNode>>::value);
+static_assert(!Internal::WritesNode<Added<HierarchyNode>>::value);
+static_assert(!Internal::WritesNode<Changed<HierarchyNode>>::value);
+
+}  // namespace
+
+
+TEST_CASE("Hierarchy - links", "[unit][ecs]") {
+    ECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(5);
+    REQUIRE(!ecs.parent(e[0]));
+    REQUIRE(children(ecs, e[0]).empty());
+
+    ecs.setParent(e[1], e[0]);
+    ecs.setParent(e[2], e[0]);
+    ecs.setParent(e[3], e[0]);
+    REQUIRE(ecs.parent(e[1]) == e[0]);
+    REQUIRE(children(ecs, e[0]) == std::vector{e[3], e[2], e[1]});
+
+    ecs.setParent(e[2], e[4]);
+    REQUIRE(ecs.parent(e[2]) == e[4]);
+    REQUIRE(children(ecs, e[0]) == std::vector{e[3], e[1]});
+    REQUIRE(children(ecs, e[4]) == std::vector{e[2]});
+
+    ecs.removeParent(e[3]);
+    REQUIRE(!ecs.parent(e[3]));
+    REQUIRE(children(ecs, e[0]) == std::vector{e[1]});
+
+    ecs.setParent(e[4], e[1]);
+    ecs.removeEntity(e[1]);
+    REQUIRE(children(ecs, e[0]).empty());
+    REQUIRE(!ecs.parent(e[4]));
+    REQUIRE(children(ecs, e[4]) == std::vector{e[2]});
+    REQUIRE(ecs.get<const HierarchyNode>(e[2]).parent() == e[4]);
+    REQUIRE(ecs.get<const HierarchyNode>(e[4]).isRoot());
+    REQUIRE(!ecs.get<const HierarchyNode>(e[4]).parent());
+}
+
+
+TEST_CASE("Hierarchy - depth first pass", "[unit][ecs]") {
+    using Totals = std::unordered_map<Entity, int, Entity::Hasher>;
+    ECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(200);
+    for (int i = 0; i < 200; ++i) {
+        ecs.insert(e[i], Offset{i});
+    }
+    // Parents have higher indices to mix up the dense order.
+    for (int i = 0; i < 190; ++i) {
+        ecs.setParent(e[i], e[190 + i * 7 % 10]);
+    }
+    for (int i = 190; i < 199; ++i) {
+        ecs.setParent(e[i], e[i + 1]);
+    }
+    ecs.setParent(e[5], e[3]);
+    ecs.removeEntity(e[150]);
+
+    auto pass = [&ecs] {
+        Totals totals;
+        ecs.eachDepthFirst([&](Entity entity, std::optional<Entity> parent) {
+            int total = ecs.get<const Offset>(entity).value;
+            if (parent) {
+                REQUIRE(totals.contains(*parent));
+                total += totals[*parent];
+            }
+            totals[entity] = total;
+        });
+        return totals;
+    };
+    Totals totals = pass();
+    REQUIRE(totals.size() == 199);
+    REQUIRE(totals[e[199]] == 199);
+    REQUIRE(totals[e[198]] == 199 + 198);
+    REQUIRE(totals[e[5]] == totals[e[3]] + 5);
+
+    ecs.sortAs<Offset, HierarchyNode>();
+    auto nodes = ecs.view<HierarchyNode>();
+    auto offsets = ecs.view<Offset>();
+    REQUIRE(std::vector(nodes.begin(), nodes.end())
+        == std::vector(offsets.begin(), offsets.begin() + 199));
+    REQUIRE(pass() == totals);
+
+    Entity root = ecs.createEntity();
+    ecs.insert(root, Offset{1000});
+    ecs.setParent(e[199], root);
+    REQUIRE(pass().at(e[198]) == 1000 + 199 + 198);
+}
+
+
+TEST_CASE("Hierarchy - grouped nodes", "[unit][ecs]") {
+    ECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(4);
+    for (Entity entity : e) {
+        ecs.insert(entity, Offset{1});
+    }
+    REQUIRE(ecs.group<HierarchyNode, Offset>());
+    ecs.setParent(e[0], e[1]);
+    ecs.setParent(e[1], e[2]);
+    ecs.setParent(e[2], e[3]);
+    REQUIRE(!ecs.sortAs<HierarchyNode, Offset>());
+
+    std::vector<Entity> order;
+    ecs.eachDepthFirst([&order](Entity entity, std::optional<Entity>) {
+        order.push_back(entity);
+    });
+    REQUIRE(order == std::vector{e[3], e[2], e[1], e[0]});
+}
+
+
+TEST_CASE("Hierarchy - nodes reordered after a pass", "[unit][ecs]") {
+    ECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(6);
+    for (Entity entity : e) {
+        ecs.insert(entity, Offset{1});
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        ecs.setParent(e[i], e[i + 1]);
+    }
+    auto pass = [&ecs] {
+        std::vector<Entity> order;
+        ecs.eachDepthFirst([&order](Entity entity, std::optional<Entity>) {
+            order.push_back(entity);
+        });
+        return order;
+    };
+    std::vector<Entity> expected{e[5], e[4], e[3], e[2], e[1], e[0]};
+    REQUIRE(pass() == expected);
+
+    std::vector<Entity> roots;
+    ecs.each<const Offset, Optional<const HierarchyNode>>(
+        [&roots](Entity entity, const Offset&, const HierarchyNode* node) {
+            if (node && node->isRoot()) {
+                roots.push_back(entity);
+            }
+        });
+    ecs.each<Changed<HierarchyNode>>(
+        0, [&roots](Entity entity, const HierarchyNode& node) {
+            if (node.isRoot()) {
+                roots.push_back(entity);
+            }
+        });
+    REQUIRE(roots == std::vector{e[5], e[5]});
+
+    SECTION("sort") {
+        REQUIRE(ecs.sort<HierarchyNode>(
+            [](const HierarchyNode& a, const HierarchyNode& b) {
+                return a.isRoot() < b.isRoot();
+            }));
+        REQUIRE(pass() == expected);
+    }
+
+    SECTION("sortAs") {
+        REQUIRE(ecs.sortAs<HierarchyNode, Offset>());
+        REQUIRE(pass() == expected);
+    }
+
+    SECTION("group") {
+        REQUIRE(ecs.group<HierarchyNode, Offset>());
+        REQUIRE(pass() == expected);
+        ecs.remove<Offset>(e[5]);
+        ecs.insert(e[5], Offset{1});
+        REQUIRE(pass() == expected);
+    }
+}
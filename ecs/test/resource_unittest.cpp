@@ -0,0 +1,76 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#include "istok/ecs/resource.hpp"
+
+#include <catch.hpp>
+
+#include <string>
+
+#include "istok/ecs.hpp"
+
+using namespace Istok::ECS;
+
+
+namespace {
+
+struct Counter {
+    int value;
+};
+
+// Neither copyable nor movable, like the GUI dispatcher.
+class Pinned {
+public:
+    explicit Pinned(std::string name) : name_(std::move(name)) {}
+
+    Pinned(const Pinned&) = delete;
+    Pinned& operator=(const Pinned&) = delete;
+
+    const std::string& name() const noexcept {
+        return name_;
+    }
+
+private:
+    std::string name_;
+};
+
+}  // namespace
+
+
+TEST_CASE("ResourceManager - basics", "[unit][ecs]") {
+    Internal::ResourceManager rm;
+    REQUIRE(rm.find<Counter>() == nullptr);
+
+    Counter& counter = rm.set<Counter>(1);
+    REQUIRE(rm.find<Counter>() == &counter);
+    REQUIRE(std::as_const(rm).find<Counter>()->value == 1);
+    REQUIRE(rm.find<Pinned>() == nullptr);
+
+    Pinned& pinned = rm.set<Pinned>("first");
+    REQUIRE(rm.find<Pinned>() == &pinned);
+    REQUIRE(rm.find<Counter>() == &counter);
+    REQUIRE(rm.set<Pinned>("second").name() == "second");
+    REQUIRE(rm.find<Pinned>()->name() == "second");
+
+    rm.remove<Counter>();
+    REQUIRE(rm.find<Counter>() == nullptr);
+    REQUIRE(rm.find<Pinned>() != nullptr);
+    rm.clear();
+    REQUIRE(rm.find<Pinned>() == nullptr);
+}
+
+
+TEST_CASE("ECSManager - resources", "[unit][ecs]") {
+    ECSManager ecs;
+    REQUIRE(ecs.tryResource<Counter>() == nullptr);
+
+    Counter& counter = ecs.setResource<Counter>(0);
+    ecs.addLoopSystem([&ecs]() noexcept { ++ecs.resource<Counter>().value; });
+    ecs.addLoopSystem([&counter]() noexcept { ++counter.value; });
+    ecs.iterate();
+    REQUIRE(std::as_const(ecs).resource<Counter>().value == 2);
+
+    ecs.setResource<Pinned>("dispatcher");
+    REQUIRE(ecs.tryResource<Pinned>()->name() == "dispatcher");
+    ecs.removeResource<Pinned>();
+    REQUIRE(std::as_const(ecs).tryResource<Pinned>() == nullptr);
+    REQUIRE(ecs.tryResource<Counter>() == &counter);
+}
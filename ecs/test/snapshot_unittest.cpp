@@ -0,0 +1,388 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#include "istok/ecs/snapshot.hpp"
+
+#include <catch.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "istok/ecs.hpp"
+
+using namespace Istok::ECS;
+
+
+namespace {
+
+struct A {
+    int value;
+    bool operator==(const A&) const = default;
+};
+
+struct B {
+    double value;
+    bool operator==(const B&) const = default;
+};
+
+struct Name {
+    std::string value;
+    bool operator==(const Name&) const = default;
+};
+
+struct Tag {};
+
+}  // namespace
+
+
+template <>
+struct Istok::ECS::Serializer<Name> {
+    static void write(SnapshotWriter& writer, const Name& name) {
+        writer.write<uint64_t>(name.value.size());
+        writer.writeBytes(name.value.data(), name.value.size());
+    }
+
+    static Name read(SnapshotReader& reader) {
+        uint64_t size = reader.read<uint64_t>();
+        if (!reader.canRead(size, 1)) {
+            return {};
+        }
+        std::string value(size, '\0');
+        reader.readBytes(value.data(), size);
+        return Name{std::move(value)};
+    }
+};
+
+
+TEST_CASE("Snapshot - round trip", "[unit][ecs]") {
+    using EntitySet = std::unordered_set<Entity, Entity::Hasher>;
+    ECSManager source;
+    std::vector<Entity> entities = source.createEntities(3000);
+    for (int i = 0; i < 3000; ++i) {
+        source.insert(entities[i], A{i});
+        if (i % 2 == 0) {
+            source.insert(entities[i], B{i * 0.5});
+        }
+        if (i % 3 == 0) {
+            source.insert(entities[i], Name{std::to_string(i)});
+            source.insert(entities[i], Tag{});
+        }
+    }
+    for (int i = 0; i < 3000; i += 7) {
+        source.removeEntity(entities[i]);
+    }
+    Tick since = source.advanceTick();
+    source.get<A>(entities[1]).value = -1;
+
+    SnapshotWriter writer;
+    source.save<A, B, Name, Tag>(writer);
+
+    ECSManager target;
+    target.group<A, B>();
+    target.query<A, Without<B>>();
+    SnapshotReader reader(writer.data());
+    REQUIRE(target.load<A, B, Name, Tag>(reader));
+    REQUIRE(reader.remaining() == 0);
+
+    REQUIRE(target.tick() == source.tick());
+    for (Entity entity : entities) {
+        REQUIRE(target.isValidEntity(entity) == source.isValidEntity(entity));
+    }
+    REQUIRE(target.count<A>() == source.count<A>());
+    REQUIRE(target.count<B>() == source.count<B>());
+    REQUIRE(target.count<Name>() == source.count<Name>());
+    REQUIRE(target.count<Tag>() == source.count<Tag>());
+    for (int i = 1; i < 3000; i += 7) {
+        REQUIRE(target.get<const A>(entities[i]) == A{i == 1 ? -1 : i});
+        REQUIRE(target.has<B>(entities[i]) == (i % 2 == 0));
+        REQUIRE(target.has<Tag>(entities[i]) == (i % 3 == 0));
+        if (i % 3 == 0) {
+            REQUIRE(target.get<const Name>(entities[i])
+                == Name{std::to_string(i)});
+        }
+    }
+
+    auto changed = target.view<Changed<A>>(since);
+    REQUIRE(EntitySet(changed.begin(), changed.end())
+        == EntitySet{entities[1]});
+
+    size_t grouped = 0;
+    target.each<A, B>([&grouped](Entity, A& a, B& b) {
+        REQUIRE(b.value == a.value * 0.5);
+        ++grouped;
+    });
+    REQUIRE(grouped == source.count<B>());
+
+    auto cached = target.query<A, Without<B>>();
+    REQUIRE(EntitySet(cached.begin(), cached.end())
+        == EntitySet(
+            source.view<A, Without<B>>().begin(),
+            source.view<A, Without<B>>().end()));
+
+    Entity reused = target.createEntity();
+    REQUIRE(reused == source.createEntity());
+}
+
+
+TEST_CASE("Snapshot - malformed data", "[unit][ecs]") {
+    ECSManager source;
+    std::vector<Entity> entities = source.createEntities(10);
+    for (Entity entity : entities) {
+        source.insert(entity, A{1});
+        source.insert(entity, Name{"name"});
+    }
+    SnapshotWriter writer;
+    source.save<A, Name>(writer);
+    std::vector<std::byte> data = writer.data();
+
+    ECSManager target;
+
+    SECTION("truncated") {
+        data.pop_back();
+        SnapshotReader reader(data);
+        REQUIRE(!target.load<A, Name>(reader));
+    }
+
+    SECTION("other component list") {
+        SnapshotReader reader(data);
+        REQUIRE(!target.load<A, B>(reader));
+    }
+
+    SECTION("component of a missing entity") {
+        // Header, entity table, tick, component size and count
+        // precede the first index of A.
+        size_t offset = 16 + 16 + 10 * 8 + sizeof(Tick) + 16;
+        size_t index = 100;
+        std::memcpy(data.data() + offset, &index, sizeof(index));
+        SnapshotReader reader(data);
+        REQUIRE(!target.load<A, Name>(reader));
+    }
+
+    REQUIRE(!target.isValidEntity(entities[0]));
+    REQUIRE(target.count<A>() == 0);
+    REQUIRE(target.count<Name>() == 0);
+    Entity entity = target.createEntity();
+    REQUIRE(entity.index() == 0);
+    REQUIRE(!target.has<A>(entity));
+}
+
+
+TEST_CASE("Snapshot - malformed free list", "[unit][ecs]") {
+    ECSManager source;
+    std::vector<Entity> entities = source.createEntities(10);
+    source.removeEntity(entities[3]);
+    source.removeEntity(entities[7]);
+    SnapshotWriter writer;
+    source.save<>(writer);
+    std::vector<std::byte> data = writer.data();
+    // Header, entity count, free list head, then the entries.
+    auto setFreeIndex = [&data](uint64_t index) {
+        std::memcpy(data.data() + 24, &index, sizeof(index));
+    };
+    auto setLink = [&data](size_t index, int32_t target) {
+        int32_t link = -target - 1;
+        std::memcpy(data.data() + 32 + index * 8, &link, sizeof(link));
+    };
+
+    ECSManager loaded;
+    SnapshotReader valid(data);
+    REQUIRE(loaded.load<>(valid));
+    REQUIRE(loaded.createEntity().index() == 7);
+    REQUIRE(loaded.createEntity().index() == 3);
+    REQUIRE(loaded.createEntity().index() == 10);
+
+    ECSManager target;
+
+    SECTION("head at a live entity") {
+        setFreeIndex(5);
+    }
+
+    SECTION("cycle") {
+        setLink(3, 7);
+    }
+
+    SECTION("unreachable free entry") {
+        setFreeIndex(3);
+    }
+
+    SnapshotReader reader(data);
+    REQUIRE(!target.load<>(reader));
+    REQUIRE(!target.isValidEntity(entities[0]));
+    REQUIRE(target.createEntity().index() == 0);
+}
+
+
+TEST_CASE("Snapshot - delta", "[unit][ecs]") {
+    ECSManager source;
+    std::vector<Entity> entities = source.createEntities(1000);
+    for (int i = 0; i < 1000; ++i) {
+        source.insert(entities[i], A{i});
+        if (i % 2 == 0) {
+            source.insert(entities[i], Name{std::to_string(i)});
+        }
+        if (i % 3 == 0) {
+            source.insert(entities[i], Tag{});
+        }
+    }
+    SnapshotWriter full;
+    source.save<A, B, Name, Tag>(full);
+    Tick epoch = source.advanceTick();
+
+    ECSManager target;
+    SnapshotReader fullReader(full.data());
+    REQUIRE(target.load<A, B, Name, Tag>(fullReader));
+    std::vector<Entity> constructed;
+    std::vector<Entity> destroyed;
+    target.onConstruct<B>([&constructed](Entity entity) {
+        constructed.push_back(entity);
+    });
+    target.onDestroy<A>([&destroyed](Entity entity) {
+        destroyed.push_back(entity);
+    });
+
+    source.removeEntity(entities[10]);
+    source.removeEntity(entities[11]);
+    Entity reused = source.createEntity();
+    source.insert(reused, B{0.5});
+    Entity created = source.createEntities(2).back();
+    source.insert(created, A{-2});
+    source.insert(created, Tag{});
+    source.get<A>(entities[20]).value = -20;
+    source.insert(entities[21], B{21.0});
+    source.remove<Name>(entities[22]);
+    source.remove<Tag>(entities[24]);
+    source.insert(entities[25], Tag{});
+
+    SnapshotWriter delta;
+    source.saveDelta<A, B, Name, Tag>(delta, epoch);
+    REQUIRE(delta.data().size() < full.data().size() / 20);
+
+    SnapshotReader reader(delta.data());
+    REQUIRE(target.applyDelta<A, B, Name, Tag>(reader));
+    REQUIRE(reader.remaining() == 0);
+
+    REQUIRE(!target.isValidEntity(entities[10]));
+    REQUIRE(!target.isValidEntity(entities[11]));
+    REQUIRE(target.isValidEntity(reused));
+    REQUIRE(target.isValidEntity(created));
+    REQUIRE(destroyed.size() == 2);
+    REQUIRE(constructed == std::vector<Entity>{reused, entities[21]});
+    REQUIRE(!target.has<A>(reused));
+    REQUIRE(target.get<const B>(reused) == B{0.5});
+    REQUIRE(target.get<const A>(created) == A{-2});
+    REQUIRE(target.has<Tag>(created));
+    REQUIRE(target.get<const A>(entities[20]) == A{-20});
+    REQUIRE(target.get<const B>(entities[21]) == B{21.0});
+    REQUIRE(!target.has<Name>(entities[22]));
+    REQUIRE(!target.has<Tag>(entities[24]));
+    REQUIRE(target.has<Tag>(entities[25]));
+    REQUIRE(target.count<A>() == source.count<A>());
+    REQUIRE(target.count<B>() == source.count<B>());
+    REQUIRE(target.count<Name>() == source.count<Name>());
+    REQUIRE(target.count<Tag>() == source.count<Tag>());
+    REQUIRE(target.createEntity() == source.createEntity());
+
+    SECTION("empty after the next epoch") {
+        Tick next = source.advanceTick();
+        SnapshotWriter empty;
+        source.saveDelta<A, B, Name, Tag>(empty, next);
+        SnapshotReader emptyReader(empty.data());
+        REQUIRE(target.applyDelta<A, B, Name, Tag>(emptyReader));
+        REQUIRE(target.count<A>() == source.count<A>());
+    }
+
+    SECTION("other component list") {
+        SnapshotReader other(delta.data());
+        REQUIRE(!target.applyDelta<A, B>(other));
+    }
+
+    SECTION("not a delta") {
+        SnapshotReader other(full.data());
+        REQUIRE(!target.applyDelta<A, B, Name, Tag>(other));
+    }
+}
+
+
+TEST_CASE("Snapshot - malformed delta", "[unit][ecs]") {
+    ECSManager source;
+    std::vector<Entity> entities = source.createEntities(10);
+    for (Entity entity : entities) {
+        source.insert(entity, A{1});
+    }
+    SnapshotWriter full;
+    source.save<A>(full);
+    Tick epoch = source.advanceTick();
+    ECSManager target;
+    SnapshotReader fullReader(full.data());
+    REQUIRE(target.load<A>(fullReader));
+
+    source.removeEntity(entities[3]);
+    source.removeEntity(entities[7]);
+    source.get<A>(entities[0]).value = 2;
+    SnapshotWriter writer;
+    source.saveDelta<A>(writer, epoch);
+    std::vector<std::byte> data = writer.data();
+    // Header, entity count, free list head, changed count, then
+    // the changed indices 3 and 7 and their entries.
+    auto set = [&data](size_t offset, auto value) {
+        std::memcpy(data.data() + offset, &value, sizeof(value));
+    };
+
+    SECTION("table larger than the changes") {
+        set(16, uint64_t{1} << 40);
+    }
+
+    SECTION("head at a live entity") {
+        set(24, uint64_t{5});
+    }
+
+    SECTION("cycle") {
+        set(56, int32_t{-7 - 1});
+    }
+
+    SECTION("truncated components") {
+        data.pop_back();
+    }
+
+    SnapshotReader reader(data);
+    REQUIRE(!target.applyDelta<A>(reader));
+    REQUIRE(target.isValidEntity(entities[3]));
+    REQUIRE(target.isValidEntity(entities[7]));
+    REQUIRE(target.count<A>() == 10);
+    REQUIRE(target.get<const A>(entities[0]) == A{1});
+    REQUIRE(target.createEntity().index() == 10);
+}
+
+
+TEST_CASE("Snapshot - delta destroying a hierarchy node", "[unit][ecs]") {
+    ECSManager source;
+    std::vector<Entity> entities = source.createEntities(4);
+    SnapshotWriter full;
+    source.save<>(full);
+    Tick epoch = source.advanceTick();
+    ECSManager target;
+    SnapshotReader fullReader(full.data());
+    REQUIRE(target.load<>(fullReader));
+    for (size_t i = 1; i < 4; ++i) {
+        target.setParent(entities[i], entities[0]);
+    }
+
+    source.removeEntity(entities[2]);
+    SnapshotWriter delta;
+    source.saveDelta<>(delta, epoch);
+    SnapshotReader reader(delta.data());
+    REQUIRE(target.applyDelta<>(reader));
+
+    std::vector<Entity> children;
+    target.eachChild(entities[0], [&children](Entity child) {
+        children.push_back(child);
+    });
+    REQUIRE(children == std::vector{entities[3], entities[1]});
+    size_t visited = 0;
+    target.eachDepthFirst([&visited](Entity, std::optional<Entity>) {
+        ++visited;
+    });
+    REQUIRE(visited == 3);
+}
@@ -4,6 +4,11 @@
 #include <catch.hpp>
 #include <catch2/trompeloeil.hpp>
 
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "test_utils.hpp"
 
 using namespace Istok::ECS;
@@ -229,3 +234,91 @@ TEST_CASE("System - manager", "[unit][ecs]") {
         sm.clear();
     }
 }
+
+
+namespace {
+
+struct A {};
+struct B {};
+struct C {};
+
+}  // namespace
+
+
+TEST_CASE("System - access conflicts", "[unit][ecs]") {
+    auto readA = SystemAccess::of<Read<A>>();
+    auto readAB = SystemAccess::of<Read<A, B>>();
+    auto writeA = SystemAccess::of<Write<A>>();
+    auto readBwriteC = SystemAccess::of<Read<B>, Write<C>>();
+    REQUIRE(!readA.conflicts(readAB));
+    REQUIRE(readA.conflicts(writeA));
+    REQUIRE(writeA.conflicts(readA));
+    REQUIRE(writeA.conflicts(writeA));
+    REQUIRE(!writeA.conflicts(readBwriteC));
+    REQUIRE(!readA.conflicts(readBwriteC));
+    REQUIRE(!readAB.conflicts(SystemAccess::of<Write<C>>()));
+    REQUIRE(readAB.conflicts(SystemAccess::of<Write<B>>()));
+}
+
+
+TEST_CASE("System - parallel stage", "[unit][ecs]") {
+    size_t workers = GENERATE(0, 3);
+    ThreadPool pool(workers);
+    std::mutex mutex;
+    std::vector<std::string> log;
+    auto record = [&](std::string event) {
+        std::lock_guard lock(mutex);
+        log.push_back(std::move(event));
+    };
+    auto system = [&](std::string name) -> Closure {
+        return [&record, name]() noexcept {
+            record(name + "+");
+            record(name + "-");
+        };
+    };
+    auto position = [&](const std::string& event) {
+        return std::ranges::find(log, event) - log.begin();
+    };
+
+    ParallelStage stage(pool);
+    stage.add(SystemAccess::of<Write<A>>(), system("0"));
+    stage.add(SystemAccess::of<Read<A>, Write<B>>(), system("1"));
+    stage.add(SystemAccess::of<Read<C>>(), system("2"));
+    stage.add(SystemAccess::of<Write<A>>(), system("3"));
+
+    for (int i = 0; i < 10; ++i) {
+        log.clear();
+        stage.run();
+        REQUIRE(log.size() == 8);
+        REQUIRE(position("0-") < position("1+"));
+        REQUIRE(position("1-") < position("3+"));
+        if (workers == 0) {
+            REQUIRE(log == std::vector<std::string>{
+                "0+", "0-", "1+", "1-", "2+", "2-", "3+", "3-"});
+        }
+    }
+}
+
+
+TEST_CASE("System - scheduled systems in manager", "[unit][ecs]") {
+    ThreadPool pool(2);
+    std::vector<std::string> log;
+    SystemManager sm;
+    sm.addLoop([&]() noexcept { log.push_back("plain"); });
+    sm.addLoop(
+        SystemAccess::of<Write<A>>(),
+        [&]() noexcept {
+            log.push_back("writeA");
+            // The rest of the stage may be running.
+            sm.pass();
+        },
+        pool);
+    sm.addLoop(
+        SystemAccess::of<Read<A>>(),
+        [&]() noexcept { log.push_back("readA"); },
+        pool);
+
+    sm.iterate();
+    REQUIRE(log == std::vector<std::string>{"plain", "writeA", "readA"});
+    sm.clear();
+}
@@ -0,0 +1,62 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#include "istok/ecs/thread_pool.hpp"
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <vector>
+
+using namespace Istok::ECS::Internal;
+
+
+TEST_CASE("ThreadPool - tasks", "[unit][ecs]") {
+    size_t workers = GENERATE(0, 1, 4);
+    ThreadPool pool(workers);
+    REQUIRE(pool.workerCount() == workers);
+
+    std::atomic<int> sum = 0;
+    TaskGroup group;
+    for (int i = 1; i <= 100; ++i) {
+        pool.submit(group, [&sum, i]() noexcept { sum += i; });
+    }
+    pool.wait(group);
+    REQUIRE(group.done());
+    REQUIRE(sum == 5050);
+}
+
+
+TEST_CASE("ThreadPool - nested tasks", "[unit][ecs]") {
+    size_t workers = GENERATE(0, 3);
+    ThreadPool pool(workers);
+
+    std::atomic<int> count = 0;
+    TaskGroup outer;
+    for (int i = 0; i < 8; ++i) {
+        pool.submit(outer, [&pool, &count]() noexcept {
+            TaskGroup inner;
+            for (int j = 0; j < 8; ++j) {
+                pool.submit(inner, [&count]() noexcept { ++count; });
+            }
+            pool.wait(inner);
+        });
+    }
+    pool.wait(outer);
+    REQUIRE(count == 64);
+}
+
+
+TEST_CASE("ThreadPool - parallelFor", "[unit][ecs]") {
+    size_t workers = GENERATE(0, 2, 7);
+    size_t count = GENERATE(0, 1, 99, 1000);
+    ThreadPool pool(workers);
+
+    std::vector<std::atomic<int>> visits(count);
+    pool.parallelFor(count, 10, [&visits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ++visits[i];
+        }
+    });
+    for (const auto& v : visits) {
+        REQUIRE(v == 1);
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <istok/ecs.hpp>
 #include "gui/base.hpp"
+#include "gui/spatial_index.hpp"
 
 namespace Istok::GUI {
 
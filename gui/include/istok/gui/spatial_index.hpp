@@ -0,0 +1,268 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <istok/ecs.hpp>
+
+#include "base.hpp"
+
+namespace Istok::GUI {
+
+// Uniform grid over the rect member of a component, e.g. WindowLocation.
+// A rect is listed in every cell it covers, so point and rect queries
+// only check the entities of the cells they touch. Rects covering more
+// than kMaxCells cells are kept in a separate list checked by every query.
+// Rects are half-open: left and top are inside, right and bottom are not.
+template <typename Component>
+class SpatialIndex {
+public:
+    using Coordinate = decltype(Component::rect.left);
+    static constexpr size_t kMaxCells = 64;
+
+    explicit SpatialIndex(Coordinate cellSize) : cellSize_(cellSize) {
+        assert(cellSize > 0);
+    }
+
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+    size_t size() const noexcept {
+        return entries_.size();
+    }
+
+    // Queues the entity for the next update(), see setupSpatialIndex().
+    void markChanged(ECS::Entity entity) {
+        changed_.push_back(entity);
+    }
+
+    // Reindexes only the entities queued since the previous update,
+    // the ones that lost the component or died leave the index.
+    void update(ECS::ECSManager& ecs) {
+        for (ECS::Entity entity : std::exchange(changed_, {})) {
+            if (ecs.isValidEntity(entity) && ecs.has<Component>(entity)) {
+                insert(entity, ecs.get<const Component>(entity).rect);
+            } else {
+                erase(entity);
+            }
+        }
+    }
+
+    // A rect equal to the indexed one is left in place.
+    void insert(ECS::Entity entity, const Rect<Coordinate>& rect) {
+        if (auto it = entries_.find(entity);
+            it != entries_.end() && it->second.rect == rect
+        ) {
+            return;
+        }
+        erase(entity);
+        Entry entry{rect, cells(rect)};
+        if (entry.cells.area() > kMaxCells) {
+            large_.push_back(entity);
+        } else {
+            forEachCell(entry.cells, [this, entity](uint64_t key) {
+                grid_[key].push_back(entity);
+            });
+        }
+        entries_.emplace(entity, entry);
+    }
+
+    void erase(ECS::Entity entity) {
+        auto it = entries_.find(entity);
+        if (it == entries_.end()) {
+            return;
+        }
+        if (it->second.cells.area() > kMaxCells) {
+            eraseFrom(large_, entity);
+        } else {
+            forEachCell(it->second.cells, [this, entity](uint64_t key) {
+                auto cell = grid_.find(key);
+                eraseFrom(cell->second, entity);
+                if (cell->second.empty()) {
+                    grid_.erase(cell);
+                }
+            });
+        }
+        entries_.erase(it);
+    }
+
+    // Calls func(entity) for every rect containing the point.
+    template <typename Func>
+    void queryPoint(Coordinate x, Coordinate y, Func&& func) const {
+        auto check = [this, x, y, &func](ECS::Entity entity) {
+            const Rect<Coordinate>& rect = entries_.at(entity).rect;
+            if (rect.left <= x && x < rect.right
+                && rect.top <= y && y < rect.bottom
+            ) {
+                func(entity);
+            }
+        };
+        auto cell = grid_.find(key(cellOf(x), cellOf(y)));
+        if (cell != grid_.end()) {
+            std::ranges::for_each(cell->second, check);
+        }
+        std::ranges::for_each(large_, check);
+    }
+
+    // Calls func(entity) once for every rect overlapping the given one.
+    template <typename Func>
+    void queryRect(const Rect<Coordinate>& area, Func&& func) const {
+        auto overlaps = [this, &area](ECS::Entity entity) {
+            const Rect<Coordinate>& rect = entries_.at(entity).rect;
+            return rect.left < area.right && area.left < rect.right
+                && rect.top < area.bottom && area.top < rect.bottom;
+        };
+        CellRange range = cells(area);
+        auto visit = [&](uint64_t cellKey, const auto& entities) {
+            for (ECS::Entity entity : entities) {
+                // Reported from the first shared cell only.
+                const CellRange& cells = entries_.at(entity).cells;
+                if (key(std::max(cells.left, range.left),
+                        std::max(cells.top, range.top)) == cellKey
+                    && overlaps(entity)
+                ) {
+                    func(entity);
+                }
+            }
+        };
+        // Large areas scan the occupied cells instead of the empty ones.
+        if (range.area() > grid_.size()) {
+            for (const auto& [cellKey, entities] : grid_) {
+                if (range.contains(cellKey)) {
+                    visit(cellKey, entities);
+                }
+            }
+        } else {
+            forEachCell(range, [&](uint64_t cellKey) {
+                if (auto cell = grid_.find(cellKey); cell != grid_.end()) {
+                    visit(cellKey, cell->second);
+                }
+            });
+        }
+        for (ECS::Entity entity : large_) {
+            if (overlaps(entity)) {
+                func(entity);
+            }
+        }
+    }
+
+private:
+    struct CellRange {
+        int32_t left;
+        int32_t top;
+        int32_t right;
+        int32_t bottom;
+
+        // Saturates instead of overflowing.
+        uint64_t area() const noexcept {
+            uint64_t width = uint64_t(int64_t(right) - left) + 1;
+            uint64_t height = uint64_t(int64_t(bottom) - top) + 1;
+            return width > UINT64_MAX / height ? UINT64_MAX : width * height;
+        }
+
+        bool contains(uint64_t cellKey) const noexcept {
+            int32_t x = int32_t(uint32_t(cellKey >> 32));
+            int32_t y = int32_t(uint32_t(cellKey));
+            return left <= x && x <= right && top <= y && y <= bottom;
+        }
+    };
+
+    struct Entry {
+        Rect<Coordinate> rect;
+        CellRange cells;
+    };
+
+    Coordinate cellSize_;
+    std::vector<ECS::Entity> changed_;
+    std::unordered_map<ECS::Entity, Entry, ECS::Entity::Hasher> entries_;
+    std::unordered_map<uint64_t, std::vector<ECS::Entity>> grid_;
+    std::vector<ECS::Entity> large_;
+
+    // Clamped, so that far coordinates share the border cells.
+    int32_t cellOf(Coordinate value) const noexcept {
+        double cell = std::floor(double(value) / double(cellSize_));
+        return static_cast<int32_t>(std::clamp(
+            cell,
+            double(std::numeric_limits<int32_t>::min()),
+            double(std::numeric_limits<int32_t>::max())));
+    }
+
+    // Cells of the inclusive corners, so empty rects still get a cell.
+    CellRange cells(const Rect<Coordinate>& rect) const noexcept {
+        int32_t left = cellOf(rect.left);
+        int32_t top = cellOf(rect.top);
+        return CellRange{
+            left, top,
+            std::max(left, cellOf(rect.right)),
+            std::max(top, cellOf(rect.bottom))};
+    }
+
+    static uint64_t key(int32_t x, int32_t y) noexcept {
+        return uint64_t(uint32_t(x)) << 32 | uint32_t(y);
+    }
+
+    template <typename Func>
+    static void forEachCell(const CellRange& range, Func&& func) {
+        for (int64_t y = range.top; y <= range.bottom; ++y) {
+            for (int64_t x = range.left; x <= range.right; ++x) {
+                func(key(int32_t(x), int32_t(y)));
+            }
+        }
+    }
+
+    static void eraseFrom(
+        std::vector<ECS::Entity>& entities, ECS::Entity entity
+    ) noexcept {
+        auto it = std::ranges::find(entities, entity);
+        assert(it != entities.end());
+        *it = entities.back();
+        entities.pop_back();
+    }
+};
+
+
+// Registers the index as an ECS resource updated by a loop system.
+// The lifecycle signals queue the inserted and replaced components,
+// so rect changes must go through ECSManager::insert() or patch().
+// Removed components leave the index at once. The listeners look
+// the index up on every call, so it may be replaced or removed.
+template <typename Component>
+SpatialIndex<Component>& setupSpatialIndex(
+    ECS::ECSManager& ecs,
+    typename SpatialIndex<Component>::Coordinate cellSize
+) {
+    using Index = SpatialIndex<Component>;
+    auto& index = ecs.setResource<Index>(cellSize);
+    ecs.each<const Component>(
+        [&index](ECS::Entity entity, const Component& component) {
+            index.insert(entity, component.rect);
+        });
+    auto markChanged = [&ecs](ECS::Entity entity) noexcept {
+        if (Index* index = ecs.tryResource<Index>()) {
+            index->markChanged(entity);
+        }
+    };
+    ecs.onConstruct<Component>(markChanged);
+    ecs.onUpdate<Component>(markChanged);
+    ecs.onDestroy<Component>([&ecs](ECS::Entity entity) noexcept {
+        if (Index* index = ecs.tryResource<Index>()) {
+            index->erase(entity);
+        }
+    });
+    ecs.addLoopSystem([&ecs]() noexcept {
+        if (Index* index = ecs.tryResource<Index>()) {
+            index->update(ecs);
+        }
+    });
+    return index;
+}
+
+}  // namespace Istok::GUI
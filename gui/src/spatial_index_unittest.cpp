@@ -0,0 +1,159 @@
+// Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
+#include "istok/gui/spatial_index.hpp"
+
+#include <catch.hpp>
+
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
+#include <istok/ecs.hpp>
+
+using namespace Istok::GUI;
+using Istok::ECS::ECSManager;
+using Istok::ECS::Entity;
+using EntitySet = std::unordered_set<Entity, Entity::Hasher>;
+
+
+namespace {
+
+EntitySet atPoint(const SpatialIndex<WindowLocation>& index, int x, int y) {
+    EntitySet result;
+    index.queryPoint(x, y, [&result](Entity entity) {
+        REQUIRE(result.insert(entity).second);
+    });
+    return result;
+}
+
+EntitySet inRect(const SpatialIndex<WindowLocation>& index, Rect<int> area) {
+    EntitySet result;
+    index.queryRect(area, [&result](Entity entity) {
+        REQUIRE(result.insert(entity).second);
+    });
+    return result;
+}
+
+}  // namespace
+
+
+TEST_CASE("SpatialIndex - queries", "[unit][gui]") {
+    ECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(4);
+    SpatialIndex<WindowLocation> index(100);
+    index.insert(e[0], {0, 0, 50, 50});
+    index.insert(e[1], {40, 40, 250, 120});
+    index.insert(e[2], {-300, -300, 5000, 5000});
+    index.insert(e[3], {300, 300, 310, 310});
+    REQUIRE(index.size() == 4);
+
+    REQUIRE(atPoint(index, 45, 45) == EntitySet{e[0], e[1], e[2]});
+    REQUIRE(atPoint(index, 50, 10) == EntitySet{e[2]});
+    REQUIRE(atPoint(index, 305, 300) == EntitySet{e[2], e[3]});
+    REQUIRE(atPoint(index, -400, 0) == EntitySet{});
+
+    REQUIRE(inRect(index, {0, 0, 1000, 1000})
+        == EntitySet{e[0], e[1], e[2], e[3]});
+    REQUIRE(inRect(index, {50, 0, 300, 40}) == EntitySet{e[2]});
+    REQUIRE(inRect(index, {200, 100, 301, 301})
+        == EntitySet{e[1], e[2], e[3]});
+
+    index.insert(e[1], {1000, 1000, 1100, 1100});
+    index.erase(e[2]);
+    REQUIRE(atPoint(index, 45, 45) == EntitySet{e[0]});
+    REQUIRE(inRect(index, {900, 900, 1001, 1001}) == EntitySet{e[1]});
+    REQUIRE(index.size() == 3);
+}
+
+
+TEST_CASE("SpatialIndex - far coordinates", "[unit][gui]") {
+    constexpr int kMin = std::numeric_limits<int>::min();
+    constexpr int kMax = std::numeric_limits<int>::max();
+    ECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(3);
+    SpatialIndex<WindowLocation> index(1);
+    index.insert(e[0], {0, 0, 2, 2});
+    index.insert(e[1], {kMin, kMin, kMax, kMax});
+    index.insert(e[2], {kMax - 2, kMax - 2, kMax, kMax});
+
+    REQUIRE(inRect(index, {-2'000'000'000, -2'000'000'000,
+        2'000'000'000, 2'000'000'000}) == EntitySet{e[0], e[1]});
+    REQUIRE(inRect(index, {kMin, kMin, kMax, kMax})
+        == EntitySet{e[0], e[1], e[2]});
+    REQUIRE(atPoint(index, kMax - 1, kMax - 1) == EntitySet{e[1], e[2]});
+    REQUIRE(atPoint(index, kMin, kMin) == EntitySet{e[1]});
+}
+
+
+TEST_CASE("SpatialIndex - change tracking", "[unit][gui]") {
+    ECSManager ecs;
+    auto& index = setupSpatialIndex<WindowLocation>(ecs, 64);
+    REQUIRE(ecs.tryResource<SpatialIndex<WindowLocation>>() == &index);
+    std::vector<Entity> e = ecs.createEntities(3);
+    ecs.insert(e[0], WindowLocation{{0, 0, 10, 10}});
+    ecs.insert(e[1], WindowLocation{{5, 5, 20, 20}});
+    ecs.iterate();
+    REQUIRE(atPoint(index, 6, 6) == EntitySet{e[0], e[1]});
+
+    ecs.patch<WindowLocation>(e[0], [](WindowLocation& location) {
+        location.rect = {100, 100, 110, 110};
+    });
+    ecs.insert(e[2], WindowLocation{{0, 0, 8, 8}});
+    ecs.remove<WindowLocation>(e[1]);
+    REQUIRE(atPoint(index, 6, 6) == EntitySet{e[0]});
+    ecs.iterate();
+    REQUIRE(atPoint(index, 6, 6) == EntitySet{e[2]});
+    REQUIRE(atPoint(index, 105, 105) == EntitySet{e[0]});
+
+    ecs.removeEntity(e[0]);
+    REQUIRE(index.size() == 1);
+}
+
+
+TEST_CASE("SpatialIndex - idle frames", "[unit][gui]") {
+    ECSManager ecs;
+    std::vector<Entity> e = ecs.createEntities(2);
+    ecs.insert(e[0], WindowLocation{{0, 0, 10, 10}});
+    auto& index = setupSpatialIndex<WindowLocation>(ecs, 64);
+    REQUIRE(atPoint(index, 6, 6) == EntitySet{e[0]});
+    ecs.insert(e[1], WindowLocation{{5, 5, 20, 20}});
+    ecs.iterate();
+    REQUIRE(index.size() == 2);
+
+    // Only queued entities are reindexed.
+    index.erase(e[0]);
+    ecs.iterate();
+    ecs.iterate();
+    REQUIRE(index.size() == 1);
+    REQUIRE(atPoint(index, 6, 6) == EntitySet{e[1]});
+
+    ecs.patch<WindowLocation>(e[0], [](WindowLocation& location) {
+        location.rect = {1, 1, 7, 7};
+    });
+    ecs.iterate();
+    REQUIRE(atPoint(index, 6, 6) == EntitySet{e[0], e[1]});
+    ecs.insert(e[0], WindowLocation{{0, 0, 2, 2}});
+    ecs.iterate();
+    REQUIRE(atPoint(index, 6, 6) == EntitySet{e[1]});
+}
+
+
+TEST_CASE("SpatialIndex - replaced resource", "[unit][gui]") {
+    ECSManager ecs;
+    setupSpatialIndex<WindowLocation>(ecs, 64);
+    Entity a = ecs.createEntity();
+    ecs.insert(a, WindowLocation{{0, 0, 10, 10}});
+    ecs.iterate();
+
+    auto& index = ecs.setResource<SpatialIndex<WindowLocation>>(32);
+    ecs.insert(a, WindowLocation{{1, 1, 10, 10}});
+    ecs.iterate();
+    REQUIRE(atPoint(index, 6, 6) == EntitySet{a});
+    ecs.removeEntity(a);
+    REQUIRE(index.size() == 0);
+
+    ecs.removeResource<SpatialIndex<WindowLocation>>();
+    Entity b = ecs.createEntity();
+    ecs.insert(b, WindowLocation{{0, 0, 10, 10}});
+    ecs.iterate();
+    ecs.removeEntity(b);
+}
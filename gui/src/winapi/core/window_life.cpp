@@ -1,6 +1,10 @@
 // Copyright 2026 Maksim Sergeevich Zholudev. All rights reserved
 #include "window_life.hpp"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <istok/ecs.hpp>
 #include <istok/logging.hpp>
 
@@ -21,20 +25,47 @@ WindowMessageHandler makeWindowMessageHandler(
     };
 }
 
+// Entities that got CreateWindowMarker since the last pass, queued
+// by the construct listener so that idle frames scan nothing.
+struct PendingWindows {
+    std::vector<ECS::Entity> entities;
+};
+
+// The windows are recorded while walking the queue and inserted after,
+// together with the marker removals.
 void createWindows(
     ECS::ECSManager& ecs, WinAPIDelegate& winapi, Dispatcher& dispatcher
 ) noexcept {
     WITH_LOGGER_PREFIX("Istok.GUI.WinAPI", "WinAPI: ");
     ecs.removeAll<NewWindowMarker>();
-    for (auto entity : ecs.view<CreateWindowMarker, WindowLocation>()) {
+    auto* queue = ecs.tryResource<PendingWindows>();
+    if (!queue || queue->entities.empty()) {
+        return;
+    }
+    // Window messages may queue more markers meanwhile.
+    std::vector<ECS::Entity> pending = std::exchange(queue->entities, {});
+    std::ranges::sort(pending, {}, &ECS::Entity::index);
+    auto duplicates = std::ranges::unique(pending);
+    pending.erase(duplicates.begin(), duplicates.end());
+    ECS::CommandBuffer commands;
+    for (ECS::Entity entity : pending) {
+        if (!ecs.isValidEntity(entity)
+            || !ecs.has<CreateWindowMarker>(entity)
+        ) {
+            continue;
+        }
+        commands.remove<CreateWindowMarker>(entity);
+        if (!ecs.has<WindowLocation>(entity)) {
+            continue;
+        }
         LOG_DEBUG("Creating window {}", entity);
         Window window(
-            winapi, ecs.get<WindowLocation>(entity).rect,
+            winapi, ecs.get<const WindowLocation>(entity).rect,
             makeWindowMessageHandler(dispatcher, entity));
-        ecs.insert(entity, std::move(window));
-        ecs.insert(entity, NewWindowMarker{});
+        commands.insert(entity, std::move(window));
+        commands.insert(entity, NewWindowMarker{});
     }
-    ecs.removeAll<CreateWindowMarker>();
+    commands.apply(ecs);
 }
 
 }  // namespace
@@ -49,6 +80,17 @@ bool setupWindowLife(ECS::ECSManager& ecs) {
             auto dispatcherContainer = std::make_unique<Dispatcher>(winapi);
             Dispatcher& dispatcher = *dispatcherContainer;
             ecs.insert(master, std::move(dispatcherContainer));
+            // Markers inserted before setup got no signal.
+            auto& pending = ecs.setResource<PendingWindows>().entities;
+            for (ECS::Entity entity : ecs.view<CreateWindowMarker>()) {
+                pending.push_back(entity);
+            }
+            ecs.onConstruct<CreateWindowMarker>(
+                [&ecs](ECS::Entity entity) {
+                    if (auto* pending = ecs.tryResource<PendingWindows>()) {
+                        pending->entities.push_back(entity);
+                    }
+                });
             ecs.addLoopSystem([&ecs, &winapi, &dispatcher]() noexcept {
                 createWindows(ecs, winapi, dispatcher); });
             ecs.addTailCleanupSystem([&ecs]() noexcept {
@@ -84,3 +84,24 @@ TEST_CASE("Window - life", "[unit][winapi]") {
     ecs.reset();
     REQUIRE(winapi.windowsCount() == 0);
 }
+
+
+TEST_CASE("Window - marked before setup", "[unit][winapi]") {
+    FakeWindowsMockWinAPI winapi;
+    auto ecs = std::make_unique<ECS::ECSManager>();
+    ECS::Entity master = ecs->createEntity();
+    setupWinAPIProxy(*ecs, master, winapi);
+
+    const ECS::Entity a = ecs->createEntity();
+    ecs->insert(a, CreateWindowMarker{});
+    ecs->insert(a, WindowLocation{Rect<int>{1, 2, 3, 4}});
+    REQUIRE(setupWindowLife(*ecs));
+    ecs->iterate();
+    REQUIRE(winapi.windowsCount() == 1);
+    REQUIRE(ecs->has<NewWindowMarker>(a));
+    REQUIRE(ecs->has<Window>(a));
+    REQUIRE(!ecs->has<CreateWindowMarker>(a));
+
+    ecs.reset();
+    REQUIRE(winapi.windowsCount() == 0);
+}
@@ -15,11 +15,13 @@ namespace {
 
 void showWindows(ECS::ECSManager& ecs, WinAPIDelegate& winapi) noexcept {
     WITH_LOGGER_PREFIX("Istok.GUI.WinAPI", "WinAPI: ");
-    for (auto entity : ecs.view<ShowWindowMarker, Window>()) {
-        LOG_DEBUG("Showing window {}", entity);
-        HWND hWnd = ecs.get<Window>(entity).getHWnd();
-        winapi.showWindow(hWnd);
-    }
+    ecs.each<const ShowWindowMarker, const Window>(
+        [&winapi](
+            ECS::Entity entity, const ShowWindowMarker&, const Window& window
+        ) {
+            LOG_DEBUG("Showing window {}", entity);
+            winapi.showWindow(window.getHWnd());
+        });
     ecs.removeAll<ShowWindowMarker>();
 }
 
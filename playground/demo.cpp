@@ -29,9 +29,10 @@ void run() {
         }});
 
     ecs.addLoopSystem([&ecs]() noexcept {
-        for (auto entity : ecs.view<NewWindowMarker>()) {
-            LOG_DEBUG("New window detected: {}", entity);
-        }
+        ecs.each<const NewWindowMarker>(
+            [](ECS::Entity entity, const NewWindowMarker&) {
+                LOG_DEBUG("New window detected: {}", entity);
+            });
     });
 
     while (ecs.count<QuitFlag>() == 0) {